@@ -2,6 +2,13 @@
 
 # Directory conventions:
 #   tests/integration/pass/*.alo  - Tests that should compile successfully
+#                                   Optional marker: // compile-flags: extra compiler flags
+#                                   Optional marker: // expect-output: a line the program prints;
+#                                   tests with it are run with empty stdin and must exit with 0
+#                                   Optional marker: // expect-remark: a remark the compiler reports
+#   tests/integration/cli/*.sh    - Scripts driving the compiler through its command line; each
+#                                   runs in an empty directory with $COMPILER and $PROJECT_DIR set
+#                                   and passes by exiting with 0
 #   tests/integration/error/*.alo - Tests that should fail compilation
 #                                   Optional marker: // expect-error: diagnostic substring
 
@@ -31,6 +38,7 @@ COMPILER="$PROJECT_DIR/build/aloha"
 INTEGRATION_DIR="$PROJECT_DIR/tests/integration"
 PASS_DIR="$INTEGRATION_DIR/pass"
 ERROR_DIR="$INTEGRATION_DIR/error"
+CLI_DIR="$INTEGRATION_DIR/cli"
 TEMP_DIR=$(mktemp -d)
 # Set ALOHA_DEV so compiler can find stdlib when running test from /tmp
 export ALOHA_DEV="$PROJECT_DIR"
@@ -124,9 +132,14 @@ run_pass_test() {
     echo -n "Testing pass/$name... "
 
     local work_file="$TEMP_DIR/$name"
+    local program="$TEMP_DIR/${name%.alo}"
     cp "$file" "$work_file"
 
-    if ! compile_output=$("$COMPILER" "$work_file" 2>&1); then
+    local flags
+    flags=$(grep -m 1 'compile-flags:' "$file" | sed 's/.*compile-flags:[[:space:]]*//')
+
+    # shellcheck disable=SC2086
+    if ! compile_output=$("$COMPILER" "$work_file" -o "$program" $flags 2>&1); then
         echo -e "${RED}✗ COMPILATION FAILED${NC}"
         echo "$compile_output" | grep -E "Error|error|Expected" | head -3
         failed=$((failed + 1))
@@ -140,6 +153,58 @@ run_pass_test() {
         return
     fi
 
+    local expected_remark
+    while IFS= read -r expected_remark; do
+        if ! echo "$compile_output" | grep -Fq "remark: $expected_remark"; then
+            echo -e "${RED}✗ MISSING REMARK${NC}"
+            echo "  Expected remark: $expected_remark"
+            failed=$((failed + 1))
+            return
+        fi
+    done < <(grep 'expect-remark:' "$file" | sed 's/.*expect-remark:[[:space:]]*//')
+
+    if grep -q 'expect-output:' "$file"; then
+        local expected_output
+        local run_output
+        expected_output=$(grep 'expect-output:' "$file" | sed 's/.*expect-output:[[:space:]]*//')
+        if ! run_output=$(cd "$TEMP_DIR" && "$program.out" < /dev/null 2>&1); then
+            echo -e "${RED}✗ RUN FAILED${NC}"
+            echo "$run_output" | head -3
+            failed=$((failed + 1))
+            return
+        fi
+        if [[ "$run_output" != "$expected_output" ]]; then
+            echo -e "${RED}✗ WRONG OUTPUT${NC}"
+            echo "  Expected: $expected_output"
+            echo "  Got:      $run_output"
+            failed=$((failed + 1))
+            return
+        fi
+    fi
+
+    echo -e "${GREEN}✓ PASS${NC}"
+    passed=$((passed + 1))
+}
+
+run_cli_test() {
+    local file="$1"
+    local name
+    name="$(basename "$file")"
+
+    total=$((total + 1))
+
+    echo -n "Testing cli/$name... "
+
+    local work_dir="$TEMP_DIR/cli-${name%.sh}"
+    mkdir -p "$work_dir"
+
+    if ! test_output=$(cd "$work_dir" && COMPILER="$COMPILER" PROJECT_DIR="$PROJECT_DIR" bash "$file" 2>&1); then
+        echo -e "${RED}✗ FAILED${NC}"
+        echo "$test_output" | tail -5
+        failed=$((failed + 1))
+        return
+    fi
+
     echo -e "${GREEN}✓ PASS${NC}"
     passed=$((passed + 1))
 }
@@ -152,6 +217,12 @@ while IFS= read -r file; do
     run_pass_test "$file"
 done < <(find "$PASS_DIR" -maxdepth 1 -name "*.alo" -type f | sort)
 
+if [ -d "$CLI_DIR" ]; then
+    while IFS= read -r file; do
+        run_cli_test "$file"
+    done < <(find "$CLI_DIR" -maxdepth 1 -name "*.sh" -type f | sort)
+fi
+
 echo ""
 echo "================================================"
 echo "  Test Summary"
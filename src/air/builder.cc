@@ -1,5 +1,6 @@
 #include "builder.h"
 #include <iostream>
+#include <limits>
 #include <sstream>
 #include "../error/internal.h"
 
@@ -100,6 +101,106 @@ namespace aloha
     return variant;
   }
 
+  bool AIRBuilder::check_match_scrutinee(TyId scrutinee_ty, Location loc)
+  {
+    if (ty_table.is_enum(scrutinee_ty) || scrutinee_ty == TyIds::INTEGER ||
+        scrutinee_ty == TyIds::STRING)
+    {
+      return true;
+    }
+
+    diagnostics.error(DiagnosticPhase::AIRBuilding, loc,
+                      "Match expression must be an enum, 'int' or 'string', got '" +
+                          ty_table.ty_name(scrutinee_ty) + "'");
+    return false;
+  }
+
+  std::optional<AIRBuilder::MatchArmPattern> AIRBuilder::resolve_match_arm_pattern(
+      const std::optional<ast::QualifiedPath> &path,
+      const std::optional<ast::LiteralPattern> &literal, Location loc,
+      TyId scrutinee_ty, const std::string &enum_name, MatchCoverage &coverage)
+  {
+    MatchArmPattern resolved;
+    if (ty_table.is_enum(scrutinee_ty) && !literal.has_value())
+    {
+      resolved.variant = resolve_match_arm_variant(path, loc, scrutinee_ty, enum_name,
+                                                   coverage.variants);
+      if (!resolved.variant.has_value())
+        return std::nullopt;
+      return resolved;
+    }
+
+    bool is_string = literal.has_value() && literal->m_kind == ast::LiteralPattern::Kind::String;
+    TyId pattern_ty = is_string ? TyIds::STRING : TyIds::INTEGER;
+    if (!literal.has_value() || pattern_ty != scrutinee_ty)
+    {
+      std::string pattern_text = literal.has_value() ? literal->to_string()
+                                                     : (path ? path->to_string() : "_");
+      diagnostics.error(DiagnosticPhase::AIRBuilding, loc,
+                        "Match arm pattern '" + pattern_text + "' cannot match a value of type '" +
+                            ty_table.ty_name(scrutinee_ty) + "'");
+      return std::nullopt;
+    }
+
+    if (is_string)
+    {
+      if (!coverage.strings.insert(literal->m_string).second)
+      {
+        diagnostics.error(DiagnosticPhase::AIRBuilding, loc,
+                          "Duplicate match arm for " + literal->to_string());
+        return std::nullopt;
+      }
+      resolved.string = literal->m_string;
+      return resolved;
+    }
+
+    resolved.range = resolve_match_arm_range(*literal, loc, coverage.ranges);
+    if (!resolved.range.has_value())
+      return std::nullopt;
+    return resolved;
+  }
+
+  std::optional<air::IntRange> AIRBuilder::resolve_match_arm_range(
+      const ast::LiteralPattern &pattern, Location loc,
+      std::vector<air::IntRange> &covered_ranges)
+  {
+    air::IntRange range{pattern.m_low, pattern.m_high};
+    if (pattern.m_kind == ast::LiteralPattern::Kind::Range && !pattern.m_inclusive)
+    {
+      if (range.m_high == std::numeric_limits<int64_t>::min())
+      {
+        range.m_low = 1; // forces the empty range error below
+        range.m_high = 0;
+      }
+      else
+      {
+        --range.m_high;
+      }
+    }
+
+    if (range.m_high < range.m_low)
+    {
+      diagnostics.error(DiagnosticPhase::AIRBuilding, loc,
+                        "Empty range pattern '" + pattern.to_string() + "'");
+      return std::nullopt;
+    }
+
+    // arms are dispatched by a switch, so every value must select one arm
+    for (const auto &covered : covered_ranges)
+    {
+      if (range.m_low <= covered.m_high && covered.m_low <= range.m_high)
+      {
+        diagnostics.error(DiagnosticPhase::AIRBuilding, loc,
+                          "Match arm pattern '" + pattern.to_string() +
+                              "' overlaps an earlier arm");
+        return std::nullopt;
+      }
+    }
+
+    covered_ranges.push_back(range);
+    return range;
+  }
+
   void AIRBuilder::check_match_exhaustive(
       bool has_wildcard, const std::unordered_set<std::string> &covered_variants,
       const std::string &enum_name, Location loc, const std::string &match_kind)
@@ -118,6 +219,25 @@ namespace aloha
     }
   }
 
+  void AIRBuilder::check_match_exhaustive(bool has_wildcard, TyId scrutinee_ty,
+                                          const MatchCoverage &coverage,
+                                          const std::string &enum_name, Location loc,
+                                          const std::string &match_kind)
+  {
+    if (ty_table.is_enum(scrutinee_ty))
+    {
+      check_match_exhaustive(has_wildcard, coverage.variants, enum_name, loc, match_kind);
+      return;
+    }
+
+    if (!has_wildcard)
+    {
+      diagnostics.error(DiagnosticPhase::AIRBuilding, loc,
+                        match_kind + " on '" + ty_table.ty_name(scrutinee_ty) +
+                            "' must include '_'");
+    }
+  }
+
   void AIRBuilder::visit(ast::MatchExpression *node)
   {
     auto scrutinee = lower_expr(node->m_scrutinee.get());
@@ -127,18 +247,18 @@ namespace aloha
       return;
     }
 
-    if (!ty_table.is_enum(scrutinee->m_ty))
+    if (!check_match_scrutinee(scrutinee->m_ty, node->m_scrutinee->m_loc))
     {
-      diagnostics.error(DiagnosticPhase::AIRBuilding, node->m_scrutinee->m_loc,
-                        "Match expression must be an enum");
       current_expr.reset();
       return;
     }
 
-    const TyInfo *enum_ty = ty_table.get_ty_info(scrutinee->m_ty);
+    const TyInfo *enum_ty = ty_table.is_enum(scrutinee->m_ty)
+                                ? ty_table.get_ty_info(scrutinee->m_ty)
+                                : nullptr;
     std::string enum_name = enum_ty ? enum_ty->m_name : "";
     bool has_wildcard = false;
-    std::unordered_set<std::string> covered_variants;
+    MatchCoverage coverage;
     std::vector<air::MatchExprArm> arms;
     TyId result_ty = TyIds::ERROR;
 
@@ -173,19 +293,30 @@ namespace aloha
         continue;
       }
 
-      auto variant_opt = resolve_match_arm_variant(
-          arm.m_pattern, arm.m_loc, scrutinee->m_ty, enum_name, covered_variants);
-      if (!variant_opt.has_value())
+      auto pattern = resolve_match_arm_pattern(arm.m_pattern, arm.m_literal, arm.m_loc,
+                                               scrutinee->m_ty, enum_name, coverage);
+      if (!pattern.has_value())
       {
         continue;
       }
 
-      const EnumVariantSymbol &variant = variant_opt.value();
-      arms.emplace_back(variant.enum_name, variant.variant_name, variant.value,
-                        std::move(value), arm.m_loc);
+      if (pattern->range.has_value())
+      {
+        arms.emplace_back(pattern->range.value(), std::move(value), arm.m_loc);
+      }
+      else if (pattern->string.has_value())
+      {
+        arms.emplace_back(pattern->string.value(), std::move(value), arm.m_loc);
+      }
+      else
+      {
+        const EnumVariantSymbol &variant = pattern->variant.value();
+        arms.emplace_back(variant.enum_name, variant.variant_name, variant.value,
+                          std::move(value), arm.m_loc);
+      }
     }
 
-    check_match_exhaustive(has_wildcard, covered_variants, enum_name, node->m_loc,
+    check_match_exhaustive(has_wildcard, scrutinee->m_ty, coverage, enum_name, node->m_loc,
                            "Match expression");
 
     current_expr = std::make_unique<air::MatchExpr>(node->m_loc, std::move(scrutinee),
@@ -675,18 +806,18 @@ namespace aloha
       return;
     }
 
-    if (!ty_table.is_enum(scrutinee->m_ty))
+    if (!check_match_scrutinee(scrutinee->m_ty, node->m_scrutinee->m_loc))
     {
-      diagnostics.error(DiagnosticPhase::AIRBuilding, node->m_scrutinee->m_loc,
-                        "Match expression must be an enum");
       current_stmt.reset();
       return;
     }
 
-    const TyInfo *enum_ty = ty_table.get_ty_info(scrutinee->m_ty);
+    const TyInfo *enum_ty = ty_table.is_enum(scrutinee->m_ty)
+                                ? ty_table.get_ty_info(scrutinee->m_ty)
+                                : nullptr;
     std::string enum_name = enum_ty ? enum_ty->m_name : "";
     bool has_wildcard = false;
-    std::unordered_set<std::string> covered_variants;
+    MatchCoverage coverage;
     std::vector<air::MatchArm> arms;
 
     for (const auto &arm : node->m_arms)
@@ -706,19 +837,30 @@ namespace aloha
         continue;
       }
 
-      auto variant_opt = resolve_match_arm_variant(
-          arm.m_pattern, arm.m_loc, scrutinee->m_ty, enum_name, covered_variants);
-      if (!variant_opt.has_value())
+      auto pattern = resolve_match_arm_pattern(arm.m_pattern, arm.m_literal, arm.m_loc,
+                                               scrutinee->m_ty, enum_name, coverage);
+      if (!pattern.has_value())
       {
         continue;
       }
 
-      const EnumVariantSymbol &variant = variant_opt.value();
-      arms.emplace_back(variant.enum_name, variant.variant_name, variant.value,
-                        std::move(body), arm.m_loc);
+      if (pattern->range.has_value())
+      {
+        arms.emplace_back(pattern->range.value(), std::move(body), arm.m_loc);
+      }
+      else if (pattern->string.has_value())
+      {
+        arms.emplace_back(pattern->string.value(), std::move(body), arm.m_loc);
+      }
+      else
+      {
+        const EnumVariantSymbol &variant = pattern->variant.value();
+        arms.emplace_back(variant.enum_name, variant.variant_name, variant.value,
+                          std::move(body), arm.m_loc);
+      }
     }
 
-    check_match_exhaustive(has_wildcard, covered_variants, enum_name, node->m_loc,
+    check_match_exhaustive(has_wildcard, scrutinee->m_ty, coverage, enum_name, node->m_loc,
                            "Match statement");
 
     current_stmt = std::make_unique<air::Match>(node->m_loc, std::move(scrutinee),
@@ -776,9 +918,36 @@ namespace aloha
 
   void AIRBuilder::visit(ast::ForLoop *node)
   {
-    diagnostics.error(DiagnosticPhase::AIRBuilding, node->m_loc,
-                      "For loops not yet supported in AIR lowering");
-    current_stmt.reset();
+    // the loop variable is visible in the header and the body only
+    push_scope();
+
+    auto init = lower_stmt(node->m_initializer.get());
+    auto condition = lower_expr(node->m_condition.get());
+    if (condition && condition->m_ty != TyIds::BOOL)
+    {
+      diagnostics.error(DiagnosticPhase::AIRBuilding, node->m_condition->m_loc,
+                        "For condition must be of type bool");
+    }
+    auto increment = lower_stmt(node->m_increment.get());
+
+    ++loop_depth;
+    std::vector<air::StmtPtr> body;
+    if (node->m_body)
+    {
+      body = lower_block(node->m_body.get());
+    }
+    --loop_depth;
+
+    pop_scope();
+
+    if (!init || !condition || !increment)
+    {
+      current_stmt.reset();
+      return;
+    }
+
+    current_stmt = std::make_unique<air::For>(node->m_loc, std::move(init), std::move(condition),
+                                              std::move(increment), std::move(body));
   }
 
   void AIRBuilder::visit(ast::Function *node)
@@ -1324,6 +1493,16 @@ namespace aloha
     return module;
   }
 
+  air::FunctionPtr AIRBuilder::build_function(ast::Function *func)
+  {
+    if (!func)
+    {
+      ALOHA_ICE("Null function passed to AIRBuilder::build_function");
+    }
+
+    return lower_function(func);
+  }
+
   air::StructDeclPtr AIRBuilder::lower_struct(ast::StructDecl *struct_decl)
   {
     const std::string &name = struct_decl->m_name;
@@ -1405,9 +1584,16 @@ namespace aloha
       body = lower_block(func->m_body.get());
     }
 
-    return std::make_unique<air::Function>(func->m_loc, name, func_symbol.id,
-                                           std::move(params), func_symbol.return_type,
-                                           std::move(body), func->m_is_extern);
+    auto air_func = std::make_unique<air::Function>(func->m_loc, name, func_symbol.id,
+                                                    std::move(params), func_symbol.return_type,
+                                                    std::move(body), func->m_is_extern);
+    air_func->m_is_foreign = func->m_is_foreign;
+    air_func->m_attributes.m_always_inline = func->has_attribute(ast::FunctionAttribute::Inline);
+    air_func->m_attributes.m_no_inline = func->has_attribute(ast::FunctionAttribute::NoInline);
+    air_func->m_attributes.m_hot = func->has_attribute(ast::FunctionAttribute::Hot);
+    air_func->m_attributes.m_cold = func->has_attribute(ast::FunctionAttribute::Cold);
+    air_func->m_attributes.m_pure = func->has_attribute(ast::FunctionAttribute::Pure);
+    return air_func;
   }
 
   air::ExprPtr AIRBuilder::lower_expr(ast::Expression *expr)
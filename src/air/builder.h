@@ -65,6 +65,10 @@ namespace aloha
 
     std::unique_ptr<air::Module> build(ast::Program *program);
 
+    // lower and type-check a single function whose declarations were already
+    // resolved, without lowering the rest of its program
+    air::FunctionPtr build_function(ast::Function *func);
+
     bool has_errors() const { return diagnostics.has_errors(); }
 
     void visit(ast::Integer *node) override;
@@ -120,14 +124,42 @@ namespace aloha
     bool is_logical_op(air::BinaryOpKind op);
     bool block_definitely_returns(const ast::StatementBlock *block) const;
     bool stmt_definitely_returns(const ast::Statement *stmt) const;
+    // values claimed by earlier arms of a match
+    struct MatchCoverage
+    {
+      std::unordered_set<std::string> variants;
+      std::vector<air::IntRange> ranges;
+      std::unordered_set<std::string> strings;
+    };
+
+    // pattern of a non-wildcard arm; exactly one member is set
+    struct MatchArmPattern
+    {
+      std::optional<EnumVariantSymbol> variant;
+      std::optional<air::IntRange> range;
+      std::optional<std::string> string;
+    };
+
+    bool check_match_scrutinee(TyId scrutinee_ty, Location loc);
+    std::optional<MatchArmPattern> resolve_match_arm_pattern(
+        const std::optional<ast::QualifiedPath> &path,
+        const std::optional<ast::LiteralPattern> &literal, Location loc,
+        TyId scrutinee_ty, const std::string &enum_name, MatchCoverage &coverage);
     std::optional<EnumVariantSymbol> resolve_match_arm_variant(
         const std::optional<ast::QualifiedPath> &pattern, Location loc,
         TyId scrutinee_ty, const std::string &enum_name,
         std::unordered_set<std::string> &covered_variants);
+    std::optional<air::IntRange> resolve_match_arm_range(
+        const ast::LiteralPattern &pattern, Location loc,
+        std::vector<air::IntRange> &covered_ranges);
     void check_match_exhaustive(bool has_wildcard,
                                 const std::unordered_set<std::string> &covered_variants,
                                 const std::string &enum_name, Location loc,
                                 const std::string &match_kind);
+    void check_match_exhaustive(bool has_wildcard, TyId scrutinee_ty,
+                                const MatchCoverage &coverage,
+                                const std::string &enum_name, Location loc,
+                                const std::string &match_kind);
 
     void push_scope();
     void pop_scope();
@@ -37,6 +37,7 @@ namespace aloha
     class If;
     class Match;
     class While;
+    class For;
     class ExprStmt;
 
     // declaration nodes
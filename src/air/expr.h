@@ -5,6 +5,7 @@
 #include "../ty/ty.h"
 #include "../frontend/location.h"
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -92,12 +93,24 @@ namespace aloha
       void accept(AIRVisitor &visitor) override { visitor.visit(this); }
     };
 
+    // inclusive bounds of an integer match pattern; a single integer has
+    // equal bounds
+    struct IntRange
+    {
+      int64_t m_low;
+      int64_t m_high;
+    };
+
+    // arms match an enum variant, an integer range or a string; which one is
+    // decided by the scrutinee type
     struct MatchExprArm
     {
       bool m_is_wildcard;
       std::string m_enum_name;
       std::string m_variant_name;
       uint32_t m_variant_value;
+      std::optional<IntRange> m_range;
+      std::optional<std::string> m_string;
       ExprPtr m_value;
       Location m_loc;
 
@@ -107,6 +120,14 @@ namespace aloha
             m_variant_name(variant_name), m_variant_value(variant_value),
             m_value(std::move(value)), m_loc(loc) {}
 
+      MatchExprArm(IntRange range, ExprPtr value, const Location &loc)
+          : m_is_wildcard(false), m_variant_value(0), m_range(range),
+            m_value(std::move(value)), m_loc(loc) {}
+
+      MatchExprArm(const std::string &string, ExprPtr value, const Location &loc)
+          : m_is_wildcard(false), m_variant_value(0), m_string(string),
+            m_value(std::move(value)), m_loc(loc) {}
+
       MatchExprArm(ExprPtr value, const Location &loc)
           : m_is_wildcard(true), m_variant_value(0),
             m_value(std::move(value)), m_loc(loc) {}
@@ -292,6 +313,7 @@ namespace aloha
       StructId m_struct_id;
       ExprPtr m_arena;
       std::vector<ExprPtr> m_field_values;
+      bool m_stack_allocated = false; // set by EscapeAnalysis when the object cannot outlive its function
 
       NewObject(const Location &loc, const std::string &struct_name,
                 StructId struct_id, ExprPtr arena,
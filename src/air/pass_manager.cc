@@ -0,0 +1,73 @@
+#include "pass_manager.h"
+#include "passes.h"
+#include <chrono>
+#include <iomanip>
+
+namespace aloha
+{
+  namespace air
+  {
+    void PassManager::run(Module &module)
+    {
+      reports.clear();
+      for (const auto &pass : passes)
+      {
+        PassReport report{pass->name(), 0.0, {}};
+
+        auto start = std::chrono::steady_clock::now();
+        pass->run(module, report.stats);
+        auto end = std::chrono::steady_clock::now();
+
+        report.elapsed_ms = std::chrono::duration<double, std::milli>(end - start).count();
+        reports.push_back(std::move(report));
+      }
+    }
+
+    void PassManager::print_report(std::ostream &os) const
+    {
+      double total_ms = 0.0;
+      for (const auto &report : reports)
+      {
+        total_ms += report.elapsed_ms;
+        os << "  " << std::left << std::setw(28) << report.name << std::right
+           << std::fixed << std::setprecision(3) << std::setw(9) << report.elapsed_ms << " ms\n";
+        for (const auto &[counter, count] : report.stats.get_counters())
+        {
+          os << "    " << std::setw(6) << count << " " << counter << "\n";
+        }
+      }
+      os << "  " << std::left << std::setw(28) << "total" << std::right
+         << std::fixed << std::setprecision(3) << std::setw(9) << total_ms << " ms\n";
+    }
+
+    void PassManager::print_remarks(std::ostream &os) const
+    {
+      for (const auto &report : reports)
+      {
+        for (const auto &remark : report.stats.get_remarks())
+        {
+          os << remark.loc.to_string() << ": remark: " << remark.message
+             << " [" << report.name << "]\n";
+        }
+      }
+    }
+
+    PassManager PassManager::default_pipeline(bool release)
+    {
+      PassManager manager;
+      // first, so the passes below see through the removed checks
+      if (release)
+        manager.add(std::make_unique<AssertElimination>());
+      manager.add(std::make_unique<ConstantFolding>());
+      manager.add(std::make_unique<ConstantPropagation>());
+      manager.add(std::make_unique<BranchSimplification>());
+      manager.add(std::make_unique<PureCallElimination>());
+      manager.add(std::make_unique<LoopCanonicalization>());
+      manager.add(std::make_unique<EscapeAnalysis>());
+      manager.add(std::make_unique<AttributeInference>());
+      manager.add(std::make_unique<BranchHints>());
+      return manager;
+    }
+
+  } // namespace air
+} // namespace aloha
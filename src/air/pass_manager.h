@@ -0,0 +1,92 @@
+#ifndef AIR_PASS_MANAGER_H_
+#define AIR_PASS_MANAGER_H_
+
+#include "air.h"
+#include "stmt.h"
+#include "../frontend/location.h"
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace aloha
+{
+  namespace air
+  {
+    // an optimization decision tied to a source location, shown with --remarks
+    struct Remark
+    {
+      Location loc;
+      std::string message;
+    };
+
+    // named counters a pass bumps for every change it makes, plus remarks
+    // explaining individual decisions
+    class PassStatistics
+    {
+    public:
+      void add(const std::string &counter, uint64_t count = 1) { counters[counter] += count; }
+      void remark(const Location &loc, std::string message)
+      {
+        remarks.push_back(Remark{loc, std::move(message)});
+      }
+
+      const std::map<std::string, uint64_t> &get_counters() const { return counters; }
+      const std::vector<Remark> &get_remarks() const { return remarks; }
+
+      uint64_t total() const
+      {
+        uint64_t sum = 0;
+        for (const auto &[name, count] : counters)
+          sum += count;
+        return sum;
+      }
+
+    private:
+      std::map<std::string, uint64_t> counters;
+      std::vector<Remark> remarks;
+    };
+
+    class Pass
+    {
+    public:
+      virtual ~Pass() = default;
+      virtual const char *name() const = 0;
+      virtual void run(Module &module, PassStatistics &stats) = 0;
+    };
+
+    struct PassReport
+    {
+      std::string name;
+      double elapsed_ms;
+      PassStatistics stats;
+    };
+
+    // Runs AIR-to-AIR transformations in the order they were added, timing
+    // each one and keeping its statistics for the report.
+    class PassManager
+    {
+    public:
+      void add(std::unique_ptr<Pass> pass) { passes.push_back(std::move(pass)); }
+
+      void run(Module &module);
+
+      const std::vector<PassReport> &get_reports() const { return reports; }
+      void print_report(std::ostream &os) const;
+      void print_remarks(std::ostream &os) const;
+
+      // cheap simplifications that are worth doing at every optimization
+      // level; release builds also compile out asserts
+      static PassManager default_pipeline(bool release = false);
+
+    private:
+      std::vector<std::unique_ptr<Pass>> passes;
+      std::vector<PassReport> reports;
+    };
+
+  } // namespace air
+} // namespace aloha
+
+#endif // AIR_PASS_MANAGER_H_
@@ -0,0 +1,1634 @@
+#include "passes.h"
+#include "runtime_abi.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <unordered_set>
+
+namespace aloha
+{
+  namespace air
+  {
+    namespace
+    {
+      bool is_literal(const Expr *expr)
+      {
+        return dynamic_cast<const IntegerLiteral *>(expr) ||
+               dynamic_cast<const FloatLiteral *>(expr) ||
+               dynamic_cast<const BoolLiteral *>(expr);
+      }
+
+      ExprPtr clone_literal(const Expr &expr, const Location &loc)
+      {
+        if (auto int_lit = dynamic_cast<const IntegerLiteral *>(&expr))
+          return std::make_unique<IntegerLiteral>(loc, int_lit->m_value);
+        if (auto float_lit = dynamic_cast<const FloatLiteral *>(&expr))
+          return std::make_unique<FloatLiteral>(loc, float_lit->m_value);
+        if (auto bool_lit = dynamic_cast<const BoolLiteral *>(&expr))
+          return std::make_unique<BoolLiteral>(loc, bool_lit->m_value);
+        return nullptr;
+      }
+
+      // integer arithmetic wraps like the generated add/sub/mul; division
+      // and remainder are left alone where they would trap or overflow
+      std::optional<int64_t> fold_integer(BinaryOpKind op, int64_t lhs, int64_t rhs)
+      {
+        auto ulhs = static_cast<uint64_t>(lhs);
+        auto urhs = static_cast<uint64_t>(rhs);
+        switch (op)
+        {
+        case BinaryOpKind::ADD:
+          return static_cast<int64_t>(ulhs + urhs);
+        case BinaryOpKind::SUB:
+          return static_cast<int64_t>(ulhs - urhs);
+        case BinaryOpKind::MUL:
+          return static_cast<int64_t>(ulhs * urhs);
+        case BinaryOpKind::DIV:
+        case BinaryOpKind::MOD:
+          if (rhs == 0 || (lhs == std::numeric_limits<int64_t>::min() && rhs == -1))
+            return std::nullopt;
+          return op == BinaryOpKind::DIV ? lhs / rhs : lhs % rhs;
+        default:
+          return std::nullopt;
+        }
+      }
+
+      std::optional<bool> compare(BinaryOpKind op, auto lhs, auto rhs)
+      {
+        switch (op)
+        {
+        case BinaryOpKind::EQ:
+          return lhs == rhs;
+        case BinaryOpKind::NE:
+          return lhs != rhs;
+        case BinaryOpKind::LT:
+          return lhs < rhs;
+        case BinaryOpKind::LE:
+          return lhs <= rhs;
+        case BinaryOpKind::GT:
+          return lhs > rhs;
+        case BinaryOpKind::GE:
+          return lhs >= rhs;
+        default:
+          return std::nullopt;
+        }
+      }
+
+      ExprPtr fold_binary(BinaryOp &node)
+      {
+        const Location &loc = node.m_loc;
+        auto lhs_bool = dynamic_cast<BoolLiteral *>(node.m_left.get());
+
+        // short-circuit operators only need a constant left operand; the
+        // right one is either never evaluated or is the result itself
+        if (lhs_bool && (node.m_op == BinaryOpKind::LOGICAL_AND ||
+                         node.m_op == BinaryOpKind::LOGICAL_OR))
+        {
+          bool short_circuits = (node.m_op == BinaryOpKind::LOGICAL_AND) != lhs_bool->m_value;
+          if (short_circuits)
+            return std::make_unique<BoolLiteral>(loc, lhs_bool->m_value);
+          return std::move(node.m_right);
+        }
+
+        if (auto lhs = dynamic_cast<IntegerLiteral *>(node.m_left.get()))
+        {
+          auto rhs = dynamic_cast<IntegerLiteral *>(node.m_right.get());
+          if (!rhs)
+            return nullptr;
+          if (auto result = fold_integer(node.m_op, lhs->m_value, rhs->m_value))
+            return std::make_unique<IntegerLiteral>(loc, *result);
+          if (auto result = compare(node.m_op, lhs->m_value, rhs->m_value))
+            return std::make_unique<BoolLiteral>(loc, *result);
+          return nullptr;
+        }
+
+        if (auto lhs = dynamic_cast<FloatLiteral *>(node.m_left.get()))
+        {
+          auto rhs = dynamic_cast<FloatLiteral *>(node.m_right.get());
+          if (!rhs)
+            return nullptr;
+          double a = lhs->m_value;
+          double b = rhs->m_value;
+          switch (node.m_op)
+          {
+          case BinaryOpKind::ADD:
+            return std::make_unique<FloatLiteral>(loc, a + b);
+          case BinaryOpKind::SUB:
+            return std::make_unique<FloatLiteral>(loc, a - b);
+          case BinaryOpKind::MUL:
+            return std::make_unique<FloatLiteral>(loc, a * b);
+          case BinaryOpKind::DIV:
+            return std::make_unique<FloatLiteral>(loc, a / b);
+          case BinaryOpKind::MOD:
+            return std::make_unique<FloatLiteral>(loc, std::fmod(a, b));
+          default:
+            // unordered comparisons differ between the generated code and C++
+            if (std::isnan(a) || std::isnan(b))
+              return nullptr;
+            if (auto result = compare(node.m_op, a, b))
+              return std::make_unique<BoolLiteral>(loc, *result);
+            return nullptr;
+          }
+        }
+
+        if (lhs_bool)
+        {
+          auto rhs = dynamic_cast<BoolLiteral *>(node.m_right.get());
+          if (!rhs)
+            return nullptr;
+          if (node.m_op == BinaryOpKind::EQ)
+            return std::make_unique<BoolLiteral>(loc, lhs_bool->m_value == rhs->m_value);
+          if (node.m_op == BinaryOpKind::NE)
+            return std::make_unique<BoolLiteral>(loc, lhs_bool->m_value != rhs->m_value);
+        }
+
+        return nullptr;
+      }
+
+      ExprPtr fold_unary(UnaryOp &node)
+      {
+        const Location &loc = node.m_loc;
+        if (node.m_op == UnaryOpKind::NEG)
+        {
+          if (auto int_lit = dynamic_cast<IntegerLiteral *>(node.m_operand.get()))
+            return std::make_unique<IntegerLiteral>(
+                loc, static_cast<int64_t>(0 - static_cast<uint64_t>(int_lit->m_value)));
+          if (auto float_lit = dynamic_cast<FloatLiteral *>(node.m_operand.get()))
+            return std::make_unique<FloatLiteral>(loc, -float_lit->m_value);
+        }
+        else if (node.m_op == UnaryOpKind::NOT)
+        {
+          if (auto bool_lit = dynamic_cast<BoolLiteral *>(node.m_operand.get()))
+            return std::make_unique<BoolLiteral>(loc, !bool_lit->m_value);
+        }
+        return nullptr;
+      }
+
+      // returns the folded replacement, or expr unchanged
+      ExprPtr fold(ExprPtr expr, PassStatistics &stats)
+      {
+        ExprPtr folded;
+        if (auto binary = dynamic_cast<BinaryOp *>(expr.get()))
+        {
+          folded = fold_binary(*binary);
+          if (folded)
+            stats.add("binary operators folded");
+        }
+        else if (auto unary = dynamic_cast<UnaryOp *>(expr.get()))
+        {
+          folded = fold_unary(*unary);
+          if (folded)
+            stats.add("unary operators folded");
+        }
+        return folded ? std::move(folded) : std::move(expr);
+      }
+
+      // whether call goes to the stdlib function called name. Like the
+      // runtime intrinsics in codegen, passes only give meaning to the
+      // stdlib's own functions; a program may define one of the same name
+      bool is_stdlib_function(const std::unordered_map<FunctionId, const Function *> &functions,
+                              const Call &call, const std::string &name)
+      {
+        auto it = functions.find(call.m_func_id);
+        return it != functions.end() && it->second->m_is_stdlib && it->second->m_name == name;
+      }
+    } // namespace
+
+    void Rewriter::rewrite(Module &module)
+    {
+      for (auto &func : module.m_functions)
+      {
+        if (func->m_is_extern)
+          continue;
+        begin_function(*func);
+        walk_block(func->m_body);
+      }
+    }
+
+    void Rewriter::walk_block(std::vector<StmtPtr> &block)
+    {
+      std::vector<StmtPtr> rewritten;
+      rewritten.reserve(block.size());
+      for (auto &stmt : block)
+      {
+        walk_stmt(stmt.get());
+        rewrite_stmt(std::move(stmt), rewritten);
+      }
+      block = std::move(rewritten);
+    }
+
+    void Rewriter::walk_stmt(Stmt *stmt)
+    {
+      if (auto decl = dynamic_cast<VarDecl *>(stmt))
+      {
+        walk_expr(decl->m_initializer);
+      }
+      else if (auto assign = dynamic_cast<Assignment *>(stmt))
+      {
+        walk_expr(assign->m_value);
+      }
+      else if (auto array_assign = dynamic_cast<ArrayAssignment *>(stmt))
+      {
+        walk_expr(array_assign->m_index);
+        walk_expr(array_assign->m_value);
+      }
+      else if (auto field_assign = dynamic_cast<FieldAssignment *>(stmt))
+      {
+        walk_expr(field_assign->m_object);
+        walk_expr(field_assign->m_value);
+      }
+      else if (auto ret = dynamic_cast<Return *>(stmt))
+      {
+        walk_expr(ret->m_value);
+      }
+      else if (auto if_stmt = dynamic_cast<If *>(stmt))
+      {
+        walk_expr(if_stmt->m_condition);
+        walk_block(if_stmt->m_then_branch);
+        walk_block(if_stmt->m_else_branch);
+      }
+      else if (auto match = dynamic_cast<Match *>(stmt))
+      {
+        walk_expr(match->m_scrutinee);
+        for (auto &arm : match->m_arms)
+          walk_block(arm.m_body);
+      }
+      else if (auto while_loop = dynamic_cast<While *>(stmt))
+      {
+        walk_expr(while_loop->m_condition);
+        walk_block(while_loop->m_body);
+      }
+      else if (auto for_loop = dynamic_cast<For *>(stmt))
+      {
+        walk_stmt(for_loop->m_init.get());
+        walk_expr(for_loop->m_condition);
+        walk_stmt(for_loop->m_increment.get());
+        walk_block(for_loop->m_body);
+      }
+      else if (auto expr_stmt = dynamic_cast<ExprStmt *>(stmt))
+      {
+        walk_expr(expr_stmt->m_expression);
+      }
+    }
+
+    void Rewriter::walk_expr(ExprPtr &expr)
+    {
+      if (!expr)
+        return;
+
+      if (auto match = dynamic_cast<MatchExpr *>(expr.get()))
+      {
+        walk_expr(match->m_scrutinee);
+        for (auto &arm : match->m_arms)
+          walk_expr(arm.m_value);
+      }
+      else if (auto binary = dynamic_cast<BinaryOp *>(expr.get()))
+      {
+        walk_expr(binary->m_left);
+        walk_expr(binary->m_right);
+      }
+      else if (auto unary = dynamic_cast<UnaryOp *>(expr.get()))
+      {
+        walk_expr(unary->m_operand);
+      }
+      else if (auto call = dynamic_cast<Call *>(expr.get()))
+      {
+        for (auto &arg : call->m_arguments)
+          walk_expr(arg);
+      }
+      else if (auto inst = dynamic_cast<StructInstantiation *>(expr.get()))
+      {
+        for (auto &value : inst->m_field_values)
+          walk_expr(value);
+      }
+      else if (auto new_obj = dynamic_cast<NewObject *>(expr.get()))
+      {
+        walk_expr(new_obj->m_arena);
+        for (auto &value : new_obj->m_field_values)
+          walk_expr(value);
+      }
+      else if (auto access = dynamic_cast<FieldAccess *>(expr.get()))
+      {
+        walk_expr(access->m_object);
+      }
+      else if (auto array = dynamic_cast<ArrayExpr *>(expr.get()))
+      {
+        for (auto &element : array->m_elements)
+          walk_expr(element);
+      }
+      else if (auto array_access = dynamic_cast<ArrayAccess *>(expr.get()))
+      {
+        walk_expr(array_access->m_array_expr);
+        walk_expr(array_access->m_index_expr);
+      }
+
+      expr = rewrite_expr(std::move(expr));
+    }
+
+    void AssertElimination::run(Module &module, PassStatistics &pass_stats)
+    {
+      stats = &pass_stats;
+      for (const auto &func : module.m_functions)
+        functions[func->m_func_id] = func.get();
+      rewrite(module);
+      functions.clear();
+      stats = nullptr;
+    }
+
+    bool AssertElimination::has_side_effects(const Expr *expr) const
+    {
+      if (!expr)
+        return false;
+
+      if (auto call = dynamic_cast<const Call *>(expr))
+      {
+        auto it = functions.find(call->m_func_id);
+        if (it == functions.end())
+          return true;
+        // effects are only inferred later, so bodies count when they are @pure
+        const Function *callee = it->second;
+        bool pure = callee->m_attributes.m_pure;
+        if (!pure && (callee->m_is_extern || callee->m_is_stdlib))
+        {
+          auto effects = runtime_function_effects(callee->m_name);
+          pure = effects && !effects->m_writes_memory && !effects->m_no_return;
+        }
+        if (!pure)
+          return true;
+        for (const auto &arg : call->m_arguments)
+        {
+          if (has_side_effects(arg.get()))
+            return true;
+        }
+        return false;
+      }
+      // the allocation itself is observable through the arena
+      if (dynamic_cast<const NewObject *>(expr))
+        return true;
+      if (auto binary = dynamic_cast<const BinaryOp *>(expr))
+        return has_side_effects(binary->m_left.get()) || has_side_effects(binary->m_right.get());
+      if (auto unary = dynamic_cast<const UnaryOp *>(expr))
+        return has_side_effects(unary->m_operand.get());
+      if (auto access = dynamic_cast<const FieldAccess *>(expr))
+        return has_side_effects(access->m_object.get());
+      if (auto array_access = dynamic_cast<const ArrayAccess *>(expr))
+      {
+        return has_side_effects(array_access->m_array_expr.get()) ||
+               has_side_effects(array_access->m_index_expr.get());
+      }
+      if (auto match = dynamic_cast<const MatchExpr *>(expr))
+      {
+        if (has_side_effects(match->m_scrutinee.get()))
+          return true;
+        for (const auto &arm : match->m_arms)
+        {
+          if (has_side_effects(arm.m_value.get()))
+            return true;
+        }
+        return false;
+      }
+      if (auto inst = dynamic_cast<const StructInstantiation *>(expr))
+      {
+        for (const auto &value : inst->m_field_values)
+        {
+          if (has_side_effects(value.get()))
+            return true;
+        }
+        return false;
+      }
+      if (auto array = dynamic_cast<const ArrayExpr *>(expr))
+      {
+        for (const auto &element : array->m_elements)
+        {
+          if (has_side_effects(element.get()))
+            return true;
+        }
+        return false;
+      }
+      // literals, variables and enum values
+      return false;
+    }
+
+    void AssertElimination::rewrite_stmt(StmtPtr stmt, std::vector<StmtPtr> &out)
+    {
+      auto expr_stmt = dynamic_cast<ExprStmt *>(stmt.get());
+      auto call = expr_stmt ? dynamic_cast<Call *>(expr_stmt->m_expression.get()) : nullptr;
+      if (!call)
+      {
+        out.push_back(std::move(stmt));
+        return;
+      }
+
+      if (!is_stdlib_function(functions, *call, "assert") &&
+          !is_stdlib_function(functions, *call, "assert_msg"))
+      {
+        out.push_back(std::move(stmt));
+        return;
+      }
+
+      for (auto &arg : call->m_arguments)
+      {
+        if (!has_side_effects(arg.get()))
+          continue;
+        stats->remark(arg->m_loc, "assert argument is still evaluated for its side effects");
+        stats->add("assert arguments kept");
+        Location loc = arg->m_loc;
+        out.push_back(std::make_unique<ExprStmt>(loc, std::move(arg)));
+      }
+      stats->remark(call->m_loc, "assert removed");
+      stats->add("asserts removed");
+    }
+
+    void ConstantFolding::run(Module &module, PassStatistics &pass_stats)
+    {
+      stats = &pass_stats;
+      rewrite(module);
+      stats = nullptr;
+    }
+
+    ExprPtr ConstantFolding::rewrite_expr(ExprPtr expr)
+    {
+      return fold(std::move(expr), *stats);
+    }
+
+    void ConstantPropagation::run(Module &module, PassStatistics &pass_stats)
+    {
+      stats = &pass_stats;
+      rewrite(module);
+      constants.clear();
+      stats = nullptr;
+    }
+
+    void ConstantPropagation::begin_function(Function &func)
+    {
+      (void)func;
+      constants.clear();
+    }
+
+    ExprPtr ConstantPropagation::rewrite_expr(ExprPtr expr)
+    {
+      if (auto ref = dynamic_cast<VarRef *>(expr.get()))
+      {
+        auto it = constants.find(ref->m_var_id);
+        if (it == constants.end())
+          return expr;
+        stats->add("uses replaced");
+        return clone_literal(*it->second, ref->m_loc);
+      }
+
+      // uses replaced below this expression may have made it foldable
+      return fold(std::move(expr), *stats);
+    }
+
+    void ConstantPropagation::rewrite_stmt(StmtPtr stmt, std::vector<StmtPtr> &out)
+    {
+      auto decl = dynamic_cast<VarDecl *>(stmt.get());
+      if (decl && !decl->m_is_mutable && decl->m_initializer &&
+          decl->m_initializer->m_ty == decl->m_var_ty && is_literal(decl->m_initializer.get()))
+      {
+        // every later use is rewritten, so the declaration itself goes away
+        constants[decl->m_var_id] = std::move(decl->m_initializer);
+        stats->add("imut variables propagated");
+        return;
+      }
+      out.push_back(std::move(stmt));
+    }
+
+    void BranchSimplification::run(Module &module, PassStatistics &pass_stats)
+    {
+      stats = &pass_stats;
+      rewrite(module);
+      stats = nullptr;
+    }
+
+    void BranchSimplification::rewrite_stmt(StmtPtr stmt, std::vector<StmtPtr> &out)
+    {
+      if (auto if_stmt = dynamic_cast<If *>(stmt.get()))
+      {
+        if (auto cond = dynamic_cast<BoolLiteral *>(if_stmt->m_condition.get()))
+        {
+          auto &taken = cond->m_value ? if_stmt->m_then_branch : if_stmt->m_else_branch;
+          for (auto &inner : taken)
+            out.push_back(std::move(inner));
+          stats->add("if statements resolved");
+          return;
+        }
+      }
+      else if (auto while_loop = dynamic_cast<While *>(stmt.get()))
+      {
+        auto cond = dynamic_cast<BoolLiteral *>(while_loop->m_condition.get());
+        if (cond && !cond->m_value)
+        {
+          stats->add("dead loops removed");
+          return;
+        }
+      }
+      out.push_back(std::move(stmt));
+    }
+
+    namespace
+    {
+      // expressions a statement evaluates exactly once each time it runs;
+      // loop headers are left out as they are evaluated repeatedly
+      std::vector<ExprPtr *> statement_operands(Stmt *stmt)
+      {
+        if (auto decl = dynamic_cast<VarDecl *>(stmt))
+          return {&decl->m_initializer};
+        if (auto assign = dynamic_cast<Assignment *>(stmt))
+          return {&assign->m_value};
+        if (auto array_assign = dynamic_cast<ArrayAssignment *>(stmt))
+          return {&array_assign->m_index, &array_assign->m_value};
+        if (auto field_assign = dynamic_cast<FieldAssignment *>(stmt))
+          return {&field_assign->m_object, &field_assign->m_value};
+        if (auto ret = dynamic_cast<Return *>(stmt))
+          return {&ret->m_value};
+        if (auto if_stmt = dynamic_cast<If *>(stmt))
+          return {&if_stmt->m_condition};
+        if (auto match = dynamic_cast<Match *>(stmt))
+          return {&match->m_scrutinee};
+        if (auto expr_stmt = dynamic_cast<ExprStmt *>(stmt))
+          return {&expr_stmt->m_expression};
+        return {};
+      }
+
+      void collect_declared(const std::vector<StmtPtr> &block, VarId &next_id,
+                            std::unordered_set<VarId> &immutable);
+
+      void collect_declared(const Stmt *stmt, VarId &next_id, std::unordered_set<VarId> &immutable)
+      {
+        if (auto decl = dynamic_cast<const VarDecl *>(stmt))
+        {
+          next_id = std::max(next_id, decl->m_var_id + 1);
+          if (!decl->m_is_mutable)
+            immutable.insert(decl->m_var_id);
+        }
+        else if (auto if_stmt = dynamic_cast<const If *>(stmt))
+        {
+          collect_declared(if_stmt->m_then_branch, next_id, immutable);
+          collect_declared(if_stmt->m_else_branch, next_id, immutable);
+        }
+        else if (auto match = dynamic_cast<const Match *>(stmt))
+        {
+          for (const auto &arm : match->m_arms)
+            collect_declared(arm.m_body, next_id, immutable);
+        }
+        else if (auto while_loop = dynamic_cast<const While *>(stmt))
+        {
+          collect_declared(while_loop->m_body, next_id, immutable);
+        }
+        else if (auto for_loop = dynamic_cast<const For *>(stmt))
+        {
+          collect_declared(for_loop->m_init.get(), next_id, immutable);
+          collect_declared(for_loop->m_body, next_id, immutable);
+        }
+      }
+
+      void collect_declared(const std::vector<StmtPtr> &block, VarId &next_id,
+                            std::unordered_set<VarId> &immutable)
+      {
+        for (const auto &stmt : block)
+          collect_declared(stmt.get(), next_id, immutable);
+      }
+    } // namespace
+
+    void PureCallElimination::run(Module &module, PassStatistics &pass_stats)
+    {
+      stats = &pass_stats;
+      pure_functions.clear();
+      for (const auto &func : module.m_functions)
+      {
+        if (func->m_attributes.m_pure)
+          pure_functions.insert(func->m_func_id);
+      }
+
+      for (auto &func : module.m_functions)
+      {
+        if (func->m_is_extern || pure_functions.empty())
+          continue;
+
+        // temporaries get ids past every variable of the function
+        immutable_vars.clear();
+        next_var_id = 0;
+        for (const auto &param : func->m_params)
+        {
+          next_var_id = std::max(next_var_id, param.m_var_id + 1);
+          if (!param.m_is_mutable)
+            immutable_vars.insert(param.m_var_id);
+        }
+        collect_declared(func->m_body, next_var_id, immutable_vars);
+
+        eliminate_block(func->m_body, {});
+      }
+      stats = nullptr;
+    }
+
+    std::optional<std::string> PureCallElimination::call_key(const Expr *expr) const
+    {
+      if (auto int_lit = dynamic_cast<const IntegerLiteral *>(expr))
+        return "i" + std::to_string(int_lit->m_value);
+      if (auto float_lit = dynamic_cast<const FloatLiteral *>(expr))
+        return "f" + std::to_string(std::bit_cast<uint64_t>(float_lit->m_value));
+      if (auto bool_lit = dynamic_cast<const BoolLiteral *>(expr))
+        return bool_lit->m_value ? "true" : "false";
+      if (auto ref = dynamic_cast<const VarRef *>(expr))
+      {
+        if (!immutable_vars.count(ref->m_var_id))
+          return std::nullopt;
+        return "v" + std::to_string(ref->m_var_id);
+      }
+
+      auto call = dynamic_cast<const Call *>(expr);
+      if (!call || !pure_functions.count(call->m_func_id))
+        return std::nullopt;
+
+      std::string key = "c" + std::to_string(call->m_func_id) + "(";
+      for (const auto &arg : call->m_arguments)
+      {
+        auto arg_key = call_key(arg.get());
+        if (!arg_key)
+          return std::nullopt;
+        key += *arg_key + ",";
+      }
+      return key + ")";
+    }
+
+    void PureCallElimination::collect_calls(ExprPtr &expr,
+                                            std::vector<std::pair<std::string, ExprPtr *>> &calls) const
+    {
+      if (!expr)
+        return;
+
+      // outer calls come before the calls in their arguments
+      if (auto call = dynamic_cast<Call *>(expr.get()))
+      {
+        if (auto key = call_key(call))
+          calls.emplace_back(std::move(*key), &expr);
+        for (auto &arg : call->m_arguments)
+          collect_calls(arg, calls);
+      }
+      else if (auto binary = dynamic_cast<BinaryOp *>(expr.get()))
+      {
+        collect_calls(binary->m_left, calls);
+        // the right operand of && and || may not be evaluated
+        if (binary->m_op != BinaryOpKind::LOGICAL_AND && binary->m_op != BinaryOpKind::LOGICAL_OR)
+          collect_calls(binary->m_right, calls);
+      }
+      else if (auto unary = dynamic_cast<UnaryOp *>(expr.get()))
+      {
+        collect_calls(unary->m_operand, calls);
+      }
+      else if (auto match = dynamic_cast<MatchExpr *>(expr.get()))
+      {
+        // only one arm runs
+        collect_calls(match->m_scrutinee, calls);
+      }
+      else if (auto inst = dynamic_cast<StructInstantiation *>(expr.get()))
+      {
+        for (auto &value : inst->m_field_values)
+          collect_calls(value, calls);
+      }
+      else if (auto object = dynamic_cast<NewObject *>(expr.get()))
+      {
+        collect_calls(object->m_arena, calls);
+        for (auto &value : object->m_field_values)
+          collect_calls(value, calls);
+      }
+      else if (auto access = dynamic_cast<FieldAccess *>(expr.get()))
+      {
+        collect_calls(access->m_object, calls);
+      }
+      else if (auto array = dynamic_cast<ArrayExpr *>(expr.get()))
+      {
+        for (auto &element : array->m_elements)
+          collect_calls(element, calls);
+      }
+      else if (auto array_access = dynamic_cast<ArrayAccess *>(expr.get()))
+      {
+        collect_calls(array_access->m_array_expr, calls);
+        collect_calls(array_access->m_index_expr, calls);
+      }
+    }
+
+    void PureCallElimination::eliminate_block(std::vector<StmtPtr> &block, AvailableCalls available)
+    {
+      std::vector<StmtPtr> rewritten;
+      rewritten.reserve(block.size());
+      for (auto &stmt : block)
+      {
+        std::vector<StmtPtr> temps;
+        eliminate_in_stmt(stmt.get(), available, temps);
+        for (auto &temp : temps)
+          rewritten.push_back(std::move(temp));
+
+        if (auto decl = dynamic_cast<VarDecl *>(stmt.get()))
+        {
+          auto key = decl->m_is_mutable || !dynamic_cast<Call *>(decl->m_initializer.get())
+                         ? std::nullopt
+                         : call_key(decl->m_initializer.get());
+          if (key)
+            available.try_emplace(*key, Available{decl->m_var_id, decl->m_name});
+        }
+        else if (auto if_stmt = dynamic_cast<If *>(stmt.get()))
+        {
+          eliminate_block(if_stmt->m_then_branch, available);
+          eliminate_block(if_stmt->m_else_branch, available);
+        }
+        else if (auto match = dynamic_cast<Match *>(stmt.get()))
+        {
+          for (auto &arm : match->m_arms)
+            eliminate_block(arm.m_body, available);
+        }
+        else if (auto while_loop = dynamic_cast<While *>(stmt.get()))
+        {
+          eliminate_block(while_loop->m_body, available);
+        }
+        else if (auto for_loop = dynamic_cast<For *>(stmt.get()))
+        {
+          eliminate_block(for_loop->m_body, available);
+        }
+
+        rewritten.push_back(std::move(stmt));
+      }
+      block = std::move(rewritten);
+    }
+
+    void PureCallElimination::eliminate_in_stmt(Stmt *stmt, AvailableCalls &available,
+                                                std::vector<StmtPtr> &temps)
+    {
+      std::vector<ExprPtr *> operands = statement_operands(stmt);
+      std::vector<std::pair<std::string, ExprPtr *>> calls;
+
+      // every change invalidates the collected slots, so start over after each
+      while (true)
+      {
+        calls.clear();
+        for (ExprPtr *operand : operands)
+          collect_calls(*operand, calls);
+
+        // replacing available calls first keeps keys in terms of the
+        // variables already holding inner results
+        auto reused = std::find_if(calls.begin(), calls.end(),
+                                   [&](const auto &call) { return available.count(call.first) != 0; });
+        if (reused != calls.end())
+        {
+          const Available &result = available.at(reused->first);
+          for (auto &[key, slot] : calls)
+          {
+            if (key != reused->first)
+              continue;
+            const Expr &call = **slot;
+            stats->add("pure calls reused");
+            stats->remark(call.m_loc, "call to '" + static_cast<const Call &>(call).m_function_name +
+                                          "' reuses the result held by '" + result.name + "'");
+            *slot = std::make_unique<VarRef>(call.m_loc, result.name, result.var_id, call.m_ty);
+          }
+          continue;
+        }
+
+        std::unordered_map<std::string, unsigned> counts;
+        for (const auto &call : calls)
+          ++counts[call.first];
+        auto repeated = std::find_if(calls.begin(), calls.end(),
+                                     [&](const auto &call) { return counts[call.first] > 1; });
+        if (repeated == calls.end())
+          break;
+
+        // evaluate the first occurrence into a temporary; the next round
+        // finds it available and replaces the others
+        ExprPtr &first = *repeated->second;
+        Location loc = first->m_loc;
+        TyId ty = first->m_ty;
+        std::string name = "pure." + std::to_string(temp_count++);
+        VarId var_id = next_var_id++;
+        immutable_vars.insert(var_id);
+        available.emplace(repeated->first, Available{var_id, name});
+        temps.push_back(std::make_unique<VarDecl>(loc, name, var_id, false, ty, std::move(first)));
+        first = std::make_unique<VarRef>(loc, name, var_id, ty);
+        stats->add("pure call results kept");
+      }
+    }
+
+    namespace
+    {
+      void collect_assigned(const std::vector<StmtPtr> &block, std::unordered_set<VarId> &assigned);
+
+      void collect_assigned(const Stmt *stmt, std::unordered_set<VarId> &assigned)
+      {
+        if (auto assign = dynamic_cast<const Assignment *>(stmt))
+        {
+          assigned.insert(assign->m_var_id);
+        }
+        else if (auto if_stmt = dynamic_cast<const If *>(stmt))
+        {
+          collect_assigned(if_stmt->m_then_branch, assigned);
+          collect_assigned(if_stmt->m_else_branch, assigned);
+        }
+        else if (auto match = dynamic_cast<const Match *>(stmt))
+        {
+          for (const auto &arm : match->m_arms)
+            collect_assigned(arm.m_body, assigned);
+        }
+        else if (auto while_loop = dynamic_cast<const While *>(stmt))
+        {
+          collect_assigned(while_loop->m_body, assigned);
+        }
+        else if (auto for_loop = dynamic_cast<const For *>(stmt))
+        {
+          collect_assigned(for_loop->m_increment.get(), assigned);
+          collect_assigned(for_loop->m_body, assigned);
+        }
+      }
+
+      void collect_assigned(const std::vector<StmtPtr> &block, std::unordered_set<VarId> &assigned)
+      {
+        for (const auto &stmt : block)
+          collect_assigned(stmt.get(), assigned);
+      }
+
+      // locals cannot be aliased, so an expression built from literals and
+      // variables the loop never assigns has the same value every iteration
+      bool is_loop_invariant(const Expr *expr, const std::unordered_set<VarId> &assigned)
+      {
+        if (dynamic_cast<const IntegerLiteral *>(expr))
+          return true;
+        if (auto ref = dynamic_cast<const VarRef *>(expr))
+          return assigned.count(ref->m_var_id) == 0;
+        if (auto unary = dynamic_cast<const UnaryOp *>(expr))
+          return is_loop_invariant(unary->m_operand.get(), assigned);
+        if (auto binary = dynamic_cast<const BinaryOp *>(expr))
+        {
+          switch (binary->m_op)
+          {
+          case BinaryOpKind::ADD:
+          case BinaryOpKind::SUB:
+          case BinaryOpKind::MUL:
+          case BinaryOpKind::DIV:
+          case BinaryOpKind::MOD:
+            return is_loop_invariant(binary->m_left.get(), assigned) &&
+                   is_loop_invariant(binary->m_right.get(), assigned);
+          default:
+            return false;
+          }
+        }
+        return false;
+      }
+
+      bool is_var(const Expr *expr, VarId var_id)
+      {
+        auto ref = dynamic_cast<const VarRef *>(expr);
+        return ref && ref->m_var_id == var_id;
+      }
+
+      // step of `i = i + c`, `i = c + i` or `i = i - c`
+      std::optional<int64_t> induction_step(const Stmt *increment, VarId var_id)
+      {
+        auto assign = dynamic_cast<const Assignment *>(increment);
+        if (!assign || assign->m_var_id != var_id)
+          return std::nullopt;
+
+        auto binary = dynamic_cast<const BinaryOp *>(assign->m_value.get());
+        if (!binary)
+          return std::nullopt;
+
+        const IntegerLiteral *amount = nullptr;
+        if (binary->m_op == BinaryOpKind::ADD || binary->m_op == BinaryOpKind::SUB)
+        {
+          if (is_var(binary->m_left.get(), var_id))
+            amount = dynamic_cast<const IntegerLiteral *>(binary->m_right.get());
+          else if (binary->m_op == BinaryOpKind::ADD && is_var(binary->m_right.get(), var_id))
+            amount = dynamic_cast<const IntegerLiteral *>(binary->m_left.get());
+        }
+        if (!amount || amount->m_value == 0)
+          return std::nullopt;
+
+        if (binary->m_op == BinaryOpKind::SUB)
+        {
+          if (amount->m_value == std::numeric_limits<int64_t>::min())
+            return std::nullopt;
+          return -amount->m_value;
+        }
+        return amount->m_value;
+      }
+
+      // `i < n`, `n > i` and friends, normalized so the variable is on the left
+      std::optional<BinaryOpKind> induction_compare(const Expr *condition, VarId var_id,
+                                                    const Expr *&bound)
+      {
+        auto binary = dynamic_cast<const BinaryOp *>(condition);
+        if (!binary)
+          return std::nullopt;
+
+        if (is_var(binary->m_left.get(), var_id))
+        {
+          bound = binary->m_right.get();
+          return binary->m_op;
+        }
+        if (!is_var(binary->m_right.get(), var_id))
+          return std::nullopt;
+
+        bound = binary->m_left.get();
+        switch (binary->m_op)
+        {
+        case BinaryOpKind::LT:
+          return BinaryOpKind::GT;
+        case BinaryOpKind::LE:
+          return BinaryOpKind::GE;
+        case BinaryOpKind::GT:
+          return BinaryOpKind::LT;
+        case BinaryOpKind::GE:
+          return BinaryOpKind::LE;
+        default:
+          return binary->m_op;
+        }
+      }
+
+      // the loop only terminates without wrapping when it steps towards the bound
+      bool steps_towards_bound(BinaryOpKind op, int64_t step)
+      {
+        switch (op)
+        {
+        case BinaryOpKind::LT:
+        case BinaryOpKind::LE:
+          return step > 0;
+        case BinaryOpKind::GT:
+        case BinaryOpKind::GE:
+          return step < 0;
+        case BinaryOpKind::NE:
+          return step == 1 || step == -1;
+        default:
+          return false;
+        }
+      }
+
+      std::optional<uint64_t> count_iterations(BinaryOpKind op, int64_t start, int64_t bound,
+                                               int64_t step)
+      {
+        auto ustart = static_cast<uint64_t>(start);
+        auto ubound = static_cast<uint64_t>(bound);
+        uint64_t stride = step > 0 ? static_cast<uint64_t>(step) : 0 - static_cast<uint64_t>(step);
+
+        // number of values the variable takes while the condition holds,
+        // before dividing by the stride
+        uint64_t distance = 0;
+        switch (op)
+        {
+        case BinaryOpKind::LT:
+          if (start >= bound)
+            return 0;
+          distance = ubound - ustart;
+          break;
+        case BinaryOpKind::LE:
+          if (start > bound)
+            return 0;
+          distance = ubound - ustart + 1;
+          break;
+        case BinaryOpKind::GT:
+          if (start <= bound)
+            return 0;
+          distance = ustart - ubound;
+          break;
+        case BinaryOpKind::GE:
+          if (start < bound)
+            return 0;
+          distance = ustart - ubound + 1;
+          break;
+        case BinaryOpKind::NE:
+          if (start == bound)
+            return 0;
+          if ((step > 0) != (start < bound))
+            return std::nullopt;
+          distance = step > 0 ? ubound - ustart : ustart - ubound;
+          break;
+        default:
+          return std::nullopt;
+        }
+
+        // the whole int range, which cannot be counted in 64 bits
+        if (distance == 0)
+          return std::nullopt;
+        return (distance - 1) / stride + 1;
+      }
+
+      // true when start + trips * step stays in range
+      bool final_value_fits(int64_t start, int64_t step, uint64_t trips)
+      {
+        if (trips > static_cast<uint64_t>(std::numeric_limits<int64_t>::max()))
+          return false;
+        int64_t travelled = 0;
+        int64_t end = 0;
+        return !__builtin_mul_overflow(static_cast<int64_t>(trips), step, &travelled) &&
+               !__builtin_add_overflow(start, travelled, &end);
+      }
+    } // namespace
+
+    void LoopCanonicalization::run(Module &module, PassStatistics &pass_stats)
+    {
+      stats = &pass_stats;
+      rewrite(module);
+      stats = nullptr;
+    }
+
+    void LoopCanonicalization::rewrite_stmt(StmtPtr stmt, std::vector<StmtPtr> &out)
+    {
+      auto for_loop = dynamic_cast<For *>(stmt.get());
+      auto init = for_loop ? dynamic_cast<VarDecl *>(for_loop->m_init.get()) : nullptr;
+      if (!init || !init->m_is_mutable || init->m_var_ty != TyIds::INTEGER)
+      {
+        out.push_back(std::move(stmt));
+        return;
+      }
+
+      VarId var_id = init->m_var_id;
+      auto step = induction_step(for_loop->m_increment.get(), var_id);
+
+      const Expr *bound = nullptr;
+      auto op = induction_compare(for_loop->m_condition.get(), var_id, bound);
+
+      std::unordered_set<VarId> assigned;
+      collect_assigned(for_loop->m_body, assigned);
+      bool body_steps = assigned.count(var_id) != 0;
+      assigned.insert(var_id);
+
+      if (!step || !op || body_steps || !steps_towards_bound(*op, *step) ||
+          bound->m_ty != TyIds::INTEGER || !is_loop_invariant(bound, assigned))
+      {
+        out.push_back(std::move(stmt));
+        return;
+      }
+
+      InductionVar induction{var_id, *step, false, std::nullopt};
+
+      // a unit step cannot jump over a strict bound, so it stops before
+      // reaching the largest or smallest int
+      if ((*op == BinaryOpKind::LT && *step == 1) || (*op == BinaryOpKind::GT && *step == -1))
+        induction.m_no_wrap = true;
+
+      auto start = dynamic_cast<const IntegerLiteral *>(init->m_initializer.get());
+      auto bound_value = dynamic_cast<const IntegerLiteral *>(bound);
+      if (start && bound_value)
+      {
+        induction.m_trip_count = count_iterations(*op, start->m_value, bound_value->m_value, *step);
+        if (induction.m_trip_count)
+        {
+          induction.m_no_wrap = final_value_fits(start->m_value, *step, *induction.m_trip_count);
+          stats->add("trip counts computed");
+
+          if (*induction.m_trip_count == 0)
+          {
+            stats->add("dead loops removed");
+            return;
+          }
+        }
+      }
+
+      for_loop->m_induction = induction;
+      stats->add("counted loops");
+      out.push_back(std::move(stmt));
+    }
+
+    void EscapeAnalysis::run(Module &module, PassStatistics &pass_stats)
+    {
+      stats = &pass_stats;
+      for (auto &func : module.m_functions)
+      {
+        if (func->m_is_extern)
+          continue;
+
+        candidates.clear();
+        candidate_vars.clear();
+        scan_block(func->m_body);
+
+        for (const auto &candidate : candidates)
+        {
+          if (!candidate.escape)
+          {
+            move_to_stack(candidate.object);
+            continue;
+          }
+          stats->add("escaping allocations");
+          stats->remark(candidate.object->m_loc, "allocation of '" + candidate.object->m_struct_name +
+                                                     "' escapes: " + *candidate.escape);
+        }
+      }
+      candidates.clear();
+      candidate_vars.clear();
+      stats = nullptr;
+    }
+
+    void EscapeAnalysis::move_to_stack(NewObject *object)
+    {
+      object->m_stack_allocated = true;
+      stats->add("allocations moved to the stack");
+      stats->remark(object->m_loc, "allocation of '" + object->m_struct_name + "' moved to the stack");
+    }
+
+    void EscapeAnalysis::scan_block(std::vector<StmtPtr> &block)
+    {
+      for (auto &stmt : block)
+        scan_stmt(stmt.get());
+    }
+
+    void EscapeAnalysis::scan_stmt(Stmt *stmt)
+    {
+      const std::string in_expression = "used in an expression";
+
+      if (auto decl = dynamic_cast<VarDecl *>(stmt))
+      {
+        if (auto object = dynamic_cast<NewObject *>(decl->m_initializer.get()))
+        {
+          scan_new_object(object);
+          candidate_vars[decl->m_var_id] = candidates.size();
+          candidates.push_back(Candidate{object, std::nullopt});
+        }
+        else
+        {
+          scan_expr(decl->m_initializer.get(), "copied into '" + decl->m_name + "'");
+        }
+      }
+      else if (auto assign = dynamic_cast<Assignment *>(stmt))
+      {
+        scan_expr(assign->m_value.get(), "assigned to '" + assign->m_var_name + "'");
+      }
+      else if (auto array_assign = dynamic_cast<ArrayAssignment *>(stmt))
+      {
+        scan_expr(array_assign->m_index.get(), in_expression);
+        scan_expr(array_assign->m_value.get(), "stored in array '" + array_assign->m_array_name + "'");
+      }
+      else if (auto field_assign = dynamic_cast<FieldAssignment *>(stmt))
+      {
+        scan_expr(field_assign->m_object.get(), std::nullopt);
+        scan_expr(field_assign->m_value.get(), "stored in field '" + field_assign->m_field_name + "'");
+      }
+      else if (auto ret = dynamic_cast<Return *>(stmt))
+      {
+        scan_expr(ret->m_value.get(), "returned from the function");
+      }
+      else if (auto if_stmt = dynamic_cast<If *>(stmt))
+      {
+        scan_expr(if_stmt->m_condition.get(), in_expression);
+        scan_block(if_stmt->m_then_branch);
+        scan_block(if_stmt->m_else_branch);
+      }
+      else if (auto match = dynamic_cast<Match *>(stmt))
+      {
+        scan_expr(match->m_scrutinee.get(), in_expression);
+        for (auto &arm : match->m_arms)
+          scan_block(arm.m_body);
+      }
+      else if (auto while_loop = dynamic_cast<While *>(stmt))
+      {
+        scan_expr(while_loop->m_condition.get(), in_expression);
+        scan_block(while_loop->m_body);
+      }
+      else if (auto for_loop = dynamic_cast<For *>(stmt))
+      {
+        scan_stmt(for_loop->m_init.get());
+        scan_expr(for_loop->m_condition.get(), in_expression);
+        scan_stmt(for_loop->m_increment.get());
+        scan_block(for_loop->m_body);
+      }
+      else if (auto expr_stmt = dynamic_cast<ExprStmt *>(stmt))
+      {
+        // the value of an expression statement is dropped
+        scan_expr(expr_stmt->m_expression.get(), std::nullopt);
+      }
+    }
+
+    void EscapeAnalysis::scan_new_object(NewObject *object)
+    {
+      scan_expr(object->m_arena.get(), "used in an expression");
+      for (auto &value : object->m_field_values)
+        scan_expr(value.get(), "stored in a field of '" + object->m_struct_name + "'");
+    }
+
+    void EscapeAnalysis::scan_expr(Expr *expr, const std::optional<std::string> &use)
+    {
+      if (!expr)
+        return;
+
+      const std::string in_expression = "used in an expression";
+
+      if (auto ref = dynamic_cast<VarRef *>(expr))
+      {
+        auto it = candidate_vars.find(ref->m_var_id);
+        if (it != candidate_vars.end() && use && !candidates[it->second].escape)
+          candidates[it->second].escape = "'" + ref->m_name + "' " + *use;
+      }
+      else if (auto object = dynamic_cast<NewObject *>(expr))
+      {
+        scan_new_object(object);
+        if (!use)
+        {
+          move_to_stack(object);
+          return;
+        }
+        stats->add("escaping allocations");
+        stats->remark(object->m_loc, "allocation of '" + object->m_struct_name + "' escapes: " + *use);
+      }
+      else if (auto access = dynamic_cast<FieldAccess *>(expr))
+      {
+        scan_expr(access->m_object.get(), std::nullopt);
+      }
+      else if (auto match = dynamic_cast<MatchExpr *>(expr))
+      {
+        scan_expr(match->m_scrutinee.get(), in_expression);
+        for (auto &arm : match->m_arms)
+          scan_expr(arm.m_value.get(), use);
+      }
+      else if (auto binary = dynamic_cast<BinaryOp *>(expr))
+      {
+        scan_expr(binary->m_left.get(), in_expression);
+        scan_expr(binary->m_right.get(), in_expression);
+      }
+      else if (auto unary = dynamic_cast<UnaryOp *>(expr))
+      {
+        scan_expr(unary->m_operand.get(), in_expression);
+      }
+      else if (auto call = dynamic_cast<Call *>(expr))
+      {
+        for (auto &arg : call->m_arguments)
+          scan_expr(arg.get(), "passed to '" + call->m_function_name + "'");
+      }
+      else if (auto inst = dynamic_cast<StructInstantiation *>(expr))
+      {
+        for (auto &value : inst->m_field_values)
+          scan_expr(value.get(), "stored in a field of '" + inst->m_struct_name + "'");
+      }
+      else if (auto array = dynamic_cast<ArrayExpr *>(expr))
+      {
+        for (auto &element : array->m_elements)
+          scan_expr(element.get(), "stored in an array");
+      }
+      else if (auto array_access = dynamic_cast<ArrayAccess *>(expr))
+      {
+        scan_expr(array_access->m_array_expr.get(), in_expression);
+        scan_expr(array_access->m_index_expr.get(), in_expression);
+      }
+    }
+
+    void AttributeInference::run(Module &module, PassStatistics &stats)
+    {
+      functions.clear();
+      struct_values.clear();
+      for (auto &func : module.m_functions)
+        functions[func->m_func_id] = func.get();
+      for (const auto &decl : module.m_structs)
+        struct_values.insert(decl->m_ty_id);
+
+      std::vector<std::pair<Function *, Summary>> bodies;
+      for (auto &func : module.m_functions)
+      {
+        if (func->m_is_extern)
+        {
+          if (auto effects = runtime_function_effects(func->m_name))
+          {
+            func->m_effects = *effects;
+            stats.add("runtime functions annotated");
+          }
+          if (func->m_attributes.m_pure)
+          {
+            func->m_effects.m_reads_memory = false;
+            func->m_effects.m_writes_memory = false;
+          }
+          func->m_effects.m_cold |= func->m_attributes.m_cold;
+          continue;
+        }
+
+        // start from the strongest claims and weaken them until nothing
+        // changes; will_return and nonnull start false instead, as
+        // recursion alone must not prove them
+        func->m_effects = FunctionEffects{};
+        func->m_effects.m_reads_memory = false;
+        func->m_effects.m_writes_memory = false;
+        func->m_effects.m_may_unwind = false;
+        func->m_effects.m_cold = func->m_attributes.m_cold;
+
+        Summary summary;
+        summarize_block(func->m_body, summary);
+        for (const auto &stmt : func->m_body)
+        {
+          auto expr_stmt = dynamic_cast<const ExprStmt *>(stmt.get());
+          if (auto call = expr_stmt ? dynamic_cast<const Call *>(expr_stmt->m_expression.get()) : nullptr)
+            summary.exits.push_back(call->m_func_id);
+        }
+        bodies.emplace_back(func.get(), std::move(summary));
+      }
+
+      bool changed = true;
+      while (changed)
+      {
+        changed = false;
+        for (auto &[func, summary] : bodies)
+          changed |= update(*func, summary);
+      }
+
+      for (Function *func : impure)
+      {
+        stats.remark(func->m_loc, "function '" + func->m_name +
+                                      "' is marked @pure but its body accesses memory");
+      }
+
+      for (const auto &[func, summary] : bodies)
+      {
+        const FunctionEffects &effects = func->m_effects;
+        if (!effects.m_reads_memory && !effects.m_writes_memory)
+          stats.add("functions not accessing memory");
+        else if (!effects.m_writes_memory)
+          stats.add("functions only reading memory");
+        if (!effects.m_may_unwind)
+          stats.add("functions not unwinding");
+        if (effects.m_will_return)
+          stats.add("functions always returning");
+        if (effects.m_no_return)
+          stats.add("functions never returning");
+        if (effects.m_nonnull_return)
+          stats.add("functions returning nonnull");
+      }
+      functions.clear();
+      struct_values.clear();
+      impure.clear();
+    }
+
+    bool AttributeInference::update(Function &func, const Summary &summary)
+    {
+      FunctionEffects next = func.m_effects;
+      next.m_reads_memory |= summary.reads_memory;
+      next.m_writes_memory |= summary.writes_memory;
+      next.m_will_return = !summary.has_unbounded_loop;
+
+      for (FunctionId callee_id : summary.callees)
+      {
+        auto it = functions.find(callee_id);
+        FunctionEffects callee = it != functions.end() ? it->second->m_effects : FunctionEffects{};
+        next.m_reads_memory |= callee.m_reads_memory;
+        next.m_writes_memory |= callee.m_writes_memory;
+        next.m_may_unwind |= callee.m_may_unwind;
+        // a callee that never returns still lets this function return on
+        // the paths not calling it, but proving that needs control flow
+        next.m_will_return &= callee.m_will_return;
+      }
+
+      // without an early return, the body reaches every top-level call
+      if (!summary.has_return)
+      {
+        for (FunctionId callee_id : summary.exits)
+        {
+          auto it = functions.find(callee_id);
+          if (it != functions.end() && it->second->m_effects.m_no_return)
+            next.m_no_return = true;
+        }
+      }
+
+      // @pure is a promise about the function's behavior that callers rely
+      // on, so it wins over what the body appears to do
+      if (func.m_attributes.m_pure && (next.m_reads_memory || next.m_writes_memory))
+      {
+        if (std::find(impure.begin(), impure.end(), &func) == impure.end())
+          impure.push_back(&func);
+        next.m_reads_memory = false;
+        next.m_writes_memory = false;
+      }
+
+      next.m_nonnull_return = func.m_return_ty == TyIds::STRING && !summary.returned.empty();
+      for (const Expr *value : summary.returned)
+        next.m_nonnull_return &= returns_nonnull(value);
+
+      bool changed = next.m_reads_memory != func.m_effects.m_reads_memory ||
+                     next.m_writes_memory != func.m_effects.m_writes_memory ||
+                     next.m_may_unwind != func.m_effects.m_may_unwind ||
+                     next.m_will_return != func.m_effects.m_will_return ||
+                     next.m_no_return != func.m_effects.m_no_return ||
+                     next.m_nonnull_return != func.m_effects.m_nonnull_return;
+      func.m_effects = next;
+      return changed;
+    }
+
+    bool AttributeInference::returns_nonnull(const Expr *expr)
+    {
+      if (dynamic_cast<const StringLiteral *>(expr))
+        return true;
+      if (auto call = dynamic_cast<const Call *>(expr))
+      {
+        auto it = functions.find(call->m_func_id);
+        return it != functions.end() && it->second->m_effects.m_nonnull_return;
+      }
+      return false;
+    }
+
+    bool AttributeInference::in_memory(const Expr *object) const
+    {
+      // a struct held by value lives in the function's own stack slots,
+      // unless it was reached through a reference further up
+      if (!struct_values.count(object->m_ty))
+        return true;
+      if (auto access = dynamic_cast<const FieldAccess *>(object))
+        return in_memory(access->m_object.get());
+      return dynamic_cast<const ArrayAccess *>(object) != nullptr;
+    }
+
+    void AttributeInference::summarize_block(const std::vector<StmtPtr> &block, Summary &summary)
+    {
+      for (const auto &stmt : block)
+        summarize_stmt(stmt.get(), summary);
+    }
+
+    void AttributeInference::summarize_stmt(const Stmt *stmt, Summary &summary)
+    {
+      if (auto decl = dynamic_cast<const VarDecl *>(stmt))
+      {
+        summarize_expr(decl->m_initializer.get(), summary);
+      }
+      else if (auto assign = dynamic_cast<const Assignment *>(stmt))
+      {
+        summarize_expr(assign->m_value.get(), summary);
+      }
+      else if (auto array_assign = dynamic_cast<const ArrayAssignment *>(stmt))
+      {
+        // arrays are passed around as pointers, so the elements may be the caller's
+        summary.writes_memory = true;
+        summarize_expr(array_assign->m_index.get(), summary);
+        summarize_expr(array_assign->m_value.get(), summary);
+      }
+      else if (auto field_assign = dynamic_cast<const FieldAssignment *>(stmt))
+      {
+        if (in_memory(field_assign->m_object.get()))
+          summary.writes_memory = true;
+        summarize_expr(field_assign->m_object.get(), summary);
+        summarize_expr(field_assign->m_value.get(), summary);
+      }
+      else if (auto ret = dynamic_cast<const Return *>(stmt))
+      {
+        summary.has_return = true;
+        if (ret->m_value)
+          summary.returned.push_back(ret->m_value.get());
+        summarize_expr(ret->m_value.get(), summary);
+      }
+      else if (auto if_stmt = dynamic_cast<const If *>(stmt))
+      {
+        summarize_expr(if_stmt->m_condition.get(), summary);
+        summarize_block(if_stmt->m_then_branch, summary);
+        summarize_block(if_stmt->m_else_branch, summary);
+      }
+      else if (auto match = dynamic_cast<const Match *>(stmt))
+      {
+        // string patterns compare the bytes
+        if (match->m_scrutinee->m_ty == TyIds::STRING)
+          summary.reads_memory = true;
+        summarize_expr(match->m_scrutinee.get(), summary);
+        for (const auto &arm : match->m_arms)
+          summarize_block(arm.m_body, summary);
+      }
+      else if (auto while_loop = dynamic_cast<const While *>(stmt))
+      {
+        summary.has_unbounded_loop = true;
+        summarize_expr(while_loop->m_condition.get(), summary);
+        summarize_block(while_loop->m_body, summary);
+      }
+      else if (auto for_loop = dynamic_cast<const For *>(stmt))
+      {
+        // only a counted loop that cannot wrap is known to finish
+        if (!for_loop->m_induction || !for_loop->m_induction->m_no_wrap)
+          summary.has_unbounded_loop = true;
+        summarize_stmt(for_loop->m_init.get(), summary);
+        summarize_expr(for_loop->m_condition.get(), summary);
+        summarize_stmt(for_loop->m_increment.get(), summary);
+        summarize_block(for_loop->m_body, summary);
+      }
+      else if (auto expr_stmt = dynamic_cast<const ExprStmt *>(stmt))
+      {
+        summarize_expr(expr_stmt->m_expression.get(), summary);
+      }
+    }
+
+    void AttributeInference::summarize_expr(const Expr *expr, Summary &summary)
+    {
+      if (!expr)
+        return;
+
+      if (auto object = dynamic_cast<const NewObject *>(expr))
+      {
+        // arena allocation writes the arena's bookkeeping
+        if (!object->m_stack_allocated)
+          summary.writes_memory = true;
+        summarize_expr(object->m_arena.get(), summary);
+        for (const auto &value : object->m_field_values)
+          summarize_expr(value.get(), summary);
+      }
+      else if (auto access = dynamic_cast<const FieldAccess *>(expr))
+      {
+        if (in_memory(access->m_object.get()))
+          summary.reads_memory = true;
+        summarize_expr(access->m_object.get(), summary);
+      }
+      else if (auto match = dynamic_cast<const MatchExpr *>(expr))
+      {
+        if (match->m_scrutinee->m_ty == TyIds::STRING)
+          summary.reads_memory = true;
+        summarize_expr(match->m_scrutinee.get(), summary);
+        for (const auto &arm : match->m_arms)
+          summarize_expr(arm.m_value.get(), summary);
+      }
+      else if (auto binary = dynamic_cast<const BinaryOp *>(expr))
+      {
+        // string equality compares the bytes
+        if (binary->m_left->m_ty == TyIds::STRING)
+          summary.reads_memory = true;
+        summarize_expr(binary->m_left.get(), summary);
+        summarize_expr(binary->m_right.get(), summary);
+      }
+      else if (auto unary = dynamic_cast<const UnaryOp *>(expr))
+      {
+        summarize_expr(unary->m_operand.get(), summary);
+      }
+      else if (auto call = dynamic_cast<const Call *>(expr))
+      {
+        summary.callees.push_back(call->m_func_id);
+        for (const auto &arg : call->m_arguments)
+          summarize_expr(arg.get(), summary);
+      }
+      else if (auto inst = dynamic_cast<const StructInstantiation *>(expr))
+      {
+        for (const auto &value : inst->m_field_values)
+          summarize_expr(value.get(), summary);
+      }
+      else if (auto array = dynamic_cast<const ArrayExpr *>(expr))
+      {
+        for (const auto &element : array->m_elements)
+          summarize_expr(element.get(), summary);
+      }
+      else if (auto array_access = dynamic_cast<const ArrayAccess *>(expr))
+      {
+        summary.reads_memory = true;
+        summarize_expr(array_access->m_array_expr.get(), summary);
+        summarize_expr(array_access->m_index_expr.get(), summary);
+      }
+    }
+
+    void BranchHints::run(Module &module, PassStatistics &pass_stats)
+    {
+      stats = &pass_stats;
+      for (const auto &func : module.m_functions)
+        functions[func->m_func_id] = func.get();
+      rewrite(module);
+      functions.clear();
+      stats = nullptr;
+    }
+
+    std::optional<BranchHint> BranchHints::hint_call(const Expr *expr) const
+    {
+      auto call = dynamic_cast<const Call *>(expr);
+      if (!call || call->m_arguments.size() != 1 || call->m_arguments[0]->m_ty != TyIds::BOOL)
+        return std::nullopt;
+
+      if (is_stdlib_function(functions, *call, "likely"))
+        return BranchHint::Likely;
+      if (is_stdlib_function(functions, *call, "unlikely"))
+        return BranchHint::Unlikely;
+      return std::nullopt;
+    }
+
+    bool BranchHints::reaches_cold_path(const std::vector<StmtPtr> &block) const
+    {
+      for (const auto &stmt : block)
+      {
+        auto expr_stmt = dynamic_cast<const ExprStmt *>(stmt.get());
+        auto call = expr_stmt ? dynamic_cast<const Call *>(expr_stmt->m_expression.get()) : nullptr;
+        if (!call)
+          continue;
+        auto it = functions.find(call->m_func_id);
+        if (it != functions.end() && (it->second->m_effects.m_no_return || it->second->m_effects.m_cold))
+          return true;
+      }
+      return false;
+    }
+
+    void BranchHints::rewrite_stmt(StmtPtr stmt, std::vector<StmtPtr> &out)
+    {
+      if (auto if_stmt = dynamic_cast<If *>(stmt.get()))
+      {
+        if (auto hint = hint_call(if_stmt->m_condition.get()))
+        {
+          auto call = static_cast<Call *>(if_stmt->m_condition.get());
+          if_stmt->m_condition = std::move(call->m_arguments[0]);
+          if_stmt->m_hint = *hint;
+          stats->add("explicit branch hints");
+        }
+        else if (if_stmt->m_hint == BranchHint::None)
+        {
+          bool then_cold = reaches_cold_path(if_stmt->m_then_branch);
+          bool else_cold = reaches_cold_path(if_stmt->m_else_branch);
+          if (then_cold != else_cold)
+          {
+            if_stmt->m_hint = then_cold ? BranchHint::Unlikely : BranchHint::Likely;
+            stats->add("branches to cold paths hinted");
+          }
+        }
+      }
+      out.push_back(std::move(stmt));
+    }
+
+  } // namespace air
+} // namespace aloha
@@ -0,0 +1,240 @@
+#ifndef AIR_PASSES_H_
+#define AIR_PASSES_H_
+
+#include "air.h"
+#include "expr.h"
+#include "stmt.h"
+#include "pass_manager.h"
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace aloha
+{
+  namespace air
+  {
+    // Walks the bodies of every function in a module. Expressions are
+    // offered to rewrite_expr bottom-up and can be replaced; statements are
+    // offered to rewrite_stmt after their children and can be replaced by any
+    // number of statements.
+    class Rewriter
+    {
+    public:
+      virtual ~Rewriter() = default;
+
+      void rewrite(Module &module);
+
+    protected:
+      virtual void begin_function(Function &func) { (void)func; }
+      virtual ExprPtr rewrite_expr(ExprPtr expr) { return expr; }
+      virtual void rewrite_stmt(StmtPtr stmt, std::vector<StmtPtr> &out)
+      {
+        out.push_back(std::move(stmt));
+      }
+
+    private:
+      void walk_block(std::vector<StmtPtr> &block);
+      void walk_stmt(Stmt *stmt);
+      void walk_expr(ExprPtr &expr);
+    };
+
+    // Drops calls to the stdlib's assert and assert_msg in release builds.
+    // Arguments that may have side effects are still evaluated, on their
+    // own; the rest disappear with the check.
+    class AssertElimination : public Pass, private Rewriter
+    {
+    public:
+      const char *name() const override { return "assert-elimination"; }
+      void run(Module &module, PassStatistics &stats) override;
+
+    private:
+      PassStatistics *stats = nullptr;
+      std::unordered_map<FunctionId, const Function *> functions;
+
+      bool has_side_effects(const Expr *expr) const;
+      void rewrite_stmt(StmtPtr stmt, std::vector<StmtPtr> &out) override;
+    };
+
+    // folds unary and binary operators whose operands are literals
+    class ConstantFolding : public Pass, private Rewriter
+    {
+    public:
+      const char *name() const override { return "constant-folding"; }
+      void run(Module &module, PassStatistics &stats) override;
+
+    private:
+      PassStatistics *stats = nullptr;
+      ExprPtr rewrite_expr(ExprPtr expr) override;
+    };
+
+    // replaces uses of imut variables initialized with a literal by the
+    // literal itself and drops the then unused declaration
+    class ConstantPropagation : public Pass, private Rewriter
+    {
+    public:
+      const char *name() const override { return "constant-propagation"; }
+      void run(Module &module, PassStatistics &stats) override;
+
+    private:
+      PassStatistics *stats = nullptr;
+      std::unordered_map<VarId, ExprPtr> constants;
+
+      void begin_function(Function &func) override;
+      ExprPtr rewrite_expr(ExprPtr expr) override;
+      void rewrite_stmt(StmtPtr stmt, std::vector<StmtPtr> &out) override;
+    };
+
+    // replaces if statements with a literal condition by the branch taken
+    // and removes while loops that never run
+    class BranchSimplification : public Pass, private Rewriter
+    {
+    public:
+      const char *name() const override { return "branch-simplification"; }
+      void run(Module &module, PassStatistics &stats) override;
+
+    private:
+      PassStatistics *stats = nullptr;
+      void rewrite_stmt(StmtPtr stmt, std::vector<StmtPtr> &out) override;
+    };
+
+    // Reuses the result of an @pure call instead of repeating it. Calls
+    // qualify when every argument is a literal, an immutable variable or
+    // another qualifying call, so equal arguments mean equal values. A call
+    // made twice in one statement is evaluated once into a fresh imut
+    // variable; later statements in the same scope read that variable, or
+    // any imut variable initialized with the same call.
+    class PureCallElimination : public Pass
+    {
+    public:
+      const char *name() const override { return "pure-call-elimination"; }
+      void run(Module &module, PassStatistics &stats) override;
+
+    private:
+      struct Available
+      {
+        VarId var_id;
+        std::string name;
+      };
+      using AvailableCalls = std::unordered_map<std::string, Available>;
+
+      PassStatistics *stats = nullptr;
+      std::unordered_set<FunctionId> pure_functions;
+      std::unordered_set<VarId> immutable_vars;
+      VarId next_var_id = 0;
+      unsigned temp_count = 0;
+
+      std::optional<std::string> call_key(const Expr *expr) const;
+      void collect_calls(ExprPtr &expr, std::vector<std::pair<std::string, ExprPtr *>> &calls) const;
+      void eliminate_block(std::vector<StmtPtr> &block, AvailableCalls available);
+      // temporaries that must be declared before stmt are added to temps
+      void eliminate_in_stmt(Stmt *stmt, AvailableCalls &available, std::vector<StmtPtr> &temps);
+    };
+
+    // recognizes for loops that count a mutable int by a constant step
+    // towards an invariant bound and records their induction variable, so
+    // codegen can emit them in the shape LLVM's loop passes expect; loops
+    // that provably never run are removed
+    class LoopCanonicalization : public Pass, private Rewriter
+    {
+    public:
+      const char *name() const override { return "loop-canonicalization"; }
+      void run(Module &module, PassStatistics &stats) override;
+
+    private:
+      PassStatistics *stats = nullptr;
+      void rewrite_stmt(StmtPtr stmt, std::vector<StmtPtr> &out) override;
+    };
+
+    // Moves new(arena) objects that cannot outlive their function to the
+    // stack. An object qualifies when it is only ever dereferenced: either
+    // directly, or through the local variable it initializes. Every other
+    // allocation site gets a remark saying how it escapes.
+    class EscapeAnalysis : public Pass
+    {
+    public:
+      const char *name() const override { return "escape-analysis"; }
+      void run(Module &module, PassStatistics &stats) override;
+
+    private:
+      // object held by a local variable, and the first use that lets it escape
+      struct Candidate
+      {
+        NewObject *object;
+        std::optional<std::string> escape;
+      };
+
+      PassStatistics *stats = nullptr;
+      std::vector<Candidate> candidates;
+      std::unordered_map<VarId, size_t> candidate_vars;
+
+      void scan_block(std::vector<StmtPtr> &block);
+      void scan_stmt(Stmt *stmt);
+      // use describes where the value goes; nullopt when it is only dereferenced
+      void scan_expr(Expr *expr, const std::optional<std::string> &use);
+      void scan_new_object(NewObject *object);
+      void move_to_stack(NewObject *object);
+    };
+
+    // Narrows the effects of every function so codegen can attach LLVM
+    // attributes. Extern functions take theirs from the runtime ABI table;
+    // bodies are summarized from what they touch themselves and from their
+    // callees, iterating to a fixpoint so recursion is handled. @pure and
+    // @cold are taken at their word.
+    class AttributeInference : public Pass
+    {
+    public:
+      const char *name() const override { return "attribute-inference"; }
+      void run(Module &module, PassStatistics &stats) override;
+
+    private:
+      // what a body does on its own, before looking at its callees
+      struct Summary
+      {
+        bool reads_memory = false;
+        bool writes_memory = false;
+        bool has_unbounded_loop = false;
+        bool has_return = false;
+        std::vector<FunctionId> callees;
+        std::vector<FunctionId> exits; // called by top-level statements, so on every path
+        std::vector<const Expr *> returned; // values of return statements
+      };
+
+      std::unordered_map<FunctionId, Function *> functions;
+      std::unordered_set<TyId> struct_values; // struct types held by value, not behind a reference
+      std::vector<Function *> impure; // @pure functions whose body accesses memory
+
+      bool in_memory(const Expr *object) const;
+      void summarize_block(const std::vector<StmtPtr> &block, Summary &summary);
+      void summarize_stmt(const Stmt *stmt, Summary &summary);
+      void summarize_expr(const Expr *expr, Summary &summary);
+      bool update(Function &func, const Summary &summary);
+      bool returns_nonnull(const Expr *expr);
+    };
+
+    // Decides which way if statements usually go. likely(cond) and
+    // unlikely(cond) from stdlib/hint.alo are unwrapped into a hint on the
+    // if; branches without one are expected to avoid paths that call a
+    // function which never returns or is @cold, like aborting on a failed
+    // check. Runs after AttributeInference, whose effects it reads.
+    class BranchHints : public Pass, private Rewriter
+    {
+    public:
+      const char *name() const override { return "branch-hints"; }
+      void run(Module &module, PassStatistics &stats) override;
+
+    private:
+      PassStatistics *stats = nullptr;
+      std::unordered_map<FunctionId, const Function *> functions;
+
+      // the hint when expr is a call to likely or unlikely
+      std::optional<BranchHint> hint_call(const Expr *expr) const;
+      bool reaches_cold_path(const std::vector<StmtPtr> &block) const;
+      void rewrite_stmt(StmtPtr stmt, std::vector<StmtPtr> &out) override;
+    };
+
+  } // namespace air
+} // namespace aloha
+
+#endif // AIR_PASSES_H_
@@ -96,6 +96,19 @@ namespace aloha
                 {
                     os << "_ =>\n";
                 }
+                else if (arm.m_range)
+                {
+                    os << arm.m_range->m_low;
+                    if (arm.m_range->m_high != arm.m_range->m_low)
+                    {
+                        os << "..=" << arm.m_range->m_high;
+                    }
+                    os << " =>\n";
+                }
+                else if (arm.m_string)
+                {
+                    os << "\"" << *arm.m_string << "\" =>\n";
+                }
                 else
                 {
                     os << arm.m_enum_name << "::" << arm.m_variant_name
@@ -182,7 +195,8 @@ namespace aloha
         {
             write_indent();
             os << "NewObject: " << node->m_struct_name << " (id="
-               << node->m_struct_id << ", ty=" << ty_name(node->m_ty) << ")\n";
+               << node->m_struct_id << ", ty=" << ty_name(node->m_ty) << ")"
+               << (node->m_stack_allocated ? " [stack]" : "") << "\n";
 
             indent += 2;
             write_indent();
@@ -350,7 +364,12 @@ namespace aloha
         void Printer::visit(If *node)
         {
             write_indent();
-            os << "If:\n";
+            os << "If:";
+            if (node->m_hint == BranchHint::Likely)
+                os << " (likely)";
+            else if (node->m_hint == BranchHint::Unlikely)
+                os << " (unlikely)";
+            os << "\n";
 
             indent += 2;
             write_indent();
@@ -405,6 +424,19 @@ namespace aloha
                 {
                     os << "_:\n";
                 }
+                else if (arm.m_range)
+                {
+                    os << arm.m_range->m_low;
+                    if (arm.m_range->m_high != arm.m_range->m_low)
+                    {
+                        os << "..=" << arm.m_range->m_high;
+                    }
+                    os << ":\n";
+                }
+                else if (arm.m_string)
+                {
+                    os << "\"" << *arm.m_string << "\":\n";
+                }
                 else
                 {
                     os << arm.m_enum_name << "::" << arm.m_variant_name
@@ -444,6 +476,56 @@ namespace aloha
             indent -= 2;
         }
 
+        void Printer::visit(For *node)
+        {
+            write_indent();
+            os << "For:\n";
+
+            indent += 2;
+            if (node->m_induction)
+            {
+                write_indent();
+                os << "Induction: step " << node->m_induction->m_step;
+                if (node->m_induction->m_no_wrap)
+                {
+                    os << ", no wrap";
+                }
+                if (node->m_induction->m_trip_count)
+                {
+                    os << ", trip count " << *node->m_induction->m_trip_count;
+                }
+                os << "\n";
+            }
+
+            write_indent();
+            os << "Init:\n";
+            indent += 2;
+            node->m_init->accept(*this);
+            indent -= 2;
+
+            write_indent();
+            os << "Condition:\n";
+            indent += 2;
+            node->m_condition->accept(*this);
+            indent -= 2;
+
+            write_indent();
+            os << "Increment:\n";
+            indent += 2;
+            node->m_increment->accept(*this);
+            indent -= 2;
+
+            write_indent();
+            os << "Body:\n";
+            indent += 2;
+            for (const auto &stmt : node->m_body)
+            {
+                stmt->accept(*this);
+            }
+            indent -= 2;
+            indent -= 2;
+        }
+
         void Printer::visit(ExprStmt *node)
         {
             write_indent();
@@ -461,6 +543,25 @@ namespace aloha
                << ", extern=" << (node->m_is_extern ? "true" : "false") << ")\n";
 
             indent += 2;
+            const FunctionAttributes &attributes = node->m_attributes;
+            if (attributes.m_always_inline || attributes.m_no_inline || attributes.m_hot ||
+                attributes.m_cold || attributes.m_pure)
+            {
+                write_indent();
+                os << "Attributes:";
+                if (attributes.m_always_inline)
+                    os << " @inline";
+                if (attributes.m_no_inline)
+                    os << " @noinline";
+                if (attributes.m_hot)
+                    os << " @hot";
+                if (attributes.m_cold)
+                    os << " @cold";
+                if (attributes.m_pure)
+                    os << " @pure";
+                os << "\n";
+            }
+
             write_indent();
             os << "Params:\n";
             indent += 2;
@@ -50,6 +50,7 @@ namespace aloha
             void visit(If *node) override;
             void visit(Match *node) override;
             void visit(While *node) override;
+            void visit(For *node) override;
             void visit(ExprStmt *node) override;
 
             // declaration visitors
@@ -0,0 +1,268 @@
+#include "runtime_abi.h"
+
+namespace aloha
+{
+  namespace air
+  {
+    namespace
+    {
+      // nothing in the runtime unwinds; everything else starts from the
+      // conservative defaults and is narrowed below
+      constexpr FunctionEffects nounwind()
+      {
+        FunctionEffects effects;
+        effects.m_may_unwind = false;
+        return effects;
+      }
+
+      // depends on nothing but its arguments
+      constexpr FunctionEffects pure()
+      {
+        FunctionEffects effects = nounwind();
+        effects.m_reads_memory = false;
+        effects.m_writes_memory = false;
+        effects.m_will_return = true;
+        return effects;
+      }
+
+      // reads only through its pointer arguments and always returns
+      constexpr FunctionEffects reads_args()
+      {
+        FunctionEffects effects = nounwind();
+        effects.m_writes_memory = false;
+        effects.m_arg_memory_only = true;
+        effects.m_will_return = true;
+        return effects;
+      }
+
+      // reads memory reached through its arguments, such as the string a
+      // struct points to, and always returns
+      constexpr FunctionEffects reads()
+      {
+        FunctionEffects effects = nounwind();
+        effects.m_writes_memory = false;
+        effects.m_will_return = true;
+        return effects;
+      }
+
+      // reads memory but aborts on bad input, so it may not return
+      constexpr FunctionEffects checked_read()
+      {
+        FunctionEffects effects = nounwind();
+        effects.m_writes_memory = false;
+        return effects;
+      }
+
+      // returns freshly allocated memory, or NULL when allocation fails
+      constexpr FunctionEffects allocates()
+      {
+        FunctionEffects effects = nounwind();
+        effects.m_noalias_return = true;
+        return effects;
+      }
+
+      constexpr FunctionEffects terminates(bool cold)
+      {
+        FunctionEffects effects = nounwind();
+        effects.m_no_return = true;
+        effects.m_cold = cold;
+        return effects;
+      }
+
+      struct RuntimeFunction
+      {
+        std::string_view name;
+        FunctionEffects effects;
+      };
+
+      constexpr RuntimeFunction runtime_functions[] = {
+          // libc, called by codegen
+          {"strlen", reads_args()},
+          {"memcmp", reads_args()},
+
+          // arena.c
+          {"aloha_arena_new", allocates()},
+          {"aloha_arena_alloc", allocates()},
+          {"aloha_arena_free_all", nounwind()},
+          {"arena_new", allocates()},
+          {"arena_free_all", nounwind()},
+
+          // io.c
+          {"aloha_sys_write", nounwind()},
+          {"aloha_sys_buffered_write", nounwind()},
+          {"aloha_sys_flush", nounwind()},
+          {"aloha_sys_write_int", nounwind()},
+          {"aloha_sys_write_float", nounwind()},
+          {"aloha_sys_read", nounwind()},
+          {"aloha_sys_input", allocates()},
+          {"aloha_sys_int_to_string", allocates()},
+          {"aloha_sys_float_to_string", allocates()},
+          {"aloha_sys_exit", terminates(false)},
+          {"aloha_sys_abort", terminates(true)},
+
+          // search.c
+          {"aloha_string_find", reads_args()},
+          {"aloha_string_find_byte", reads_args()},
+          {"aloha_string_starts_with", reads_args()},
+          {"aloha_string_compare", reads_args()},
+          {"aloha_string_split", allocates()},
+          {"string_find", reads_args()},
+          {"string_find_byte", reads_args()},
+          {"string_starts_with", reads_args()},
+          {"string_compare", reads_args()},
+          {"string_split", allocates()},
+
+          // slice.c
+          {"aloha_slice_check", checked_read()},
+          {"aloha_slice_equals", reads_args()},
+          {"aloha_slice_compare", reads_args()},
+          {"aloha_slice_hash", reads_args()},
+          {"aloha_slice_find", reads_args()},
+          {"aloha_slice_write", nounwind()},
+          // a slice is a struct pointing at its source, which is not
+          // argument memory
+          {"slice_equals", reads()},
+          {"slice_equals_string", reads()},
+          {"slice_compare", reads()},
+          {"slice_hash", reads()},
+          {"string_hash", reads_args()},
+          {"slice_find", reads()},
+
+          // builder.c; the bytes live behind the builder's handle
+          {"aloha_string_builder_new", allocates()},
+          {"aloha_string_builder_append", nounwind()},
+          {"aloha_string_builder_append_int", nounwind()},
+          {"aloha_string_builder_append_float", nounwind()},
+          {"aloha_string_builder_append_char", nounwind()},
+          {"aloha_string_builder_len", reads_args()},
+          {"aloha_string_builder_finish", nounwind()},
+          {"string_builder_new", allocates()},
+          {"string_builder_append", nounwind()},
+          {"string_builder_append_int", nounwind()},
+          {"string_builder_append_float", nounwind()},
+          {"string_builder_append_char", nounwind()},
+          {"string_builder_len", reads_args()},
+          {"string_builder_finish", nounwind()},
+
+          // file.c
+          {"aloha_file_open", nounwind()},
+          {"aloha_file_close", nounwind()},
+          {"aloha_file_map", allocates()},
+          {"aloha_mapped_file_ok", pure()},
+          {"aloha_mapped_file_contents", nounwind()},
+          {"aloha_file_unmap", nounwind()},
+          {"file_open", nounwind()},
+          {"file_close", nounwind()},
+          {"file_map", allocates()},
+          {"mapped_file_ok", pure()},
+          {"mapped_file_contents", nounwind()},
+          {"file_unmap", nounwind()},
+
+          // reader.c; a reader's buffer lives behind its handle
+          {"aloha_line_reader_new", allocates()},
+          {"aloha_line_reader_next", nounwind()},
+          {"aloha_line_reader_line", nounwind()},
+          {"aloha_read_all", allocates()},
+          {"line_reader_new", allocates()},
+          {"line_reader_next", nounwind()},
+          {"line_reader_line", nounwind()},
+          {"read_all", allocates()},
+
+          // string.c
+          {"aloha_string_alloc", allocates()},
+          {"aloha_string_free", nounwind()},
+          {"aloha_string_from_cstr", allocates()},
+          {"aloha_foreign_strings_free", nounwind()},
+          {"foreign_strings_free", nounwind()},
+          {"aloha_sys_strlen", reads_args()},
+          {"aloha_sys_str_eq", reads_args()},
+          {"aloha_string_char_at", checked_read()},
+          {"aloha_string_clone", allocates()},
+          {"aloha_string_concat", allocates()},
+          {"aloha_string_slice", allocates()},
+          {"aloha_string_from_int", allocates()},
+          {"aloha_string_from_float", allocates()},
+          {"string_len", reads_args()},
+          {"string_char_at", checked_read()},
+          {"string_clone", allocates()},
+          {"string_concat", allocates()},
+          {"string_slice", allocates()},
+          {"string_from_int", allocates()},
+          {"string_from_float", allocates()},
+
+          // parse.c; the status read by aloha_parse_ok is global
+          {"aloha_parse_int", nounwind()},
+          {"aloha_parse_float", nounwind()},
+          {"aloha_parse_ok", nounwind()},
+          {"aloha_parse_ints", nounwind()},
+          {"parse_int", nounwind()},
+          {"parse_float", nounwind()},
+          {"parse_ints", nounwind()},
+
+          // vector.c; a vector's elements live behind its handle rather than
+          // in it, so reads are not limited to argument memory
+          {"aloha_vec_int_new", allocates()},
+          {"aloha_vec_int_push", nounwind()},
+          {"aloha_vec_int_len", reads_args()},
+          {"aloha_vec_int_get", checked_read()},
+          {"aloha_vec_int_set", nounwind()},
+          {"aloha_vec_string_new", allocates()},
+          {"aloha_vec_string_push", nounwind()},
+          {"aloha_vec_string_len", reads_args()},
+          {"aloha_vec_string_get", checked_read()},
+          {"aloha_vec_string_set", nounwind()},
+          {"vec_int_new", allocates()},
+          {"vec_int_push", nounwind()},
+          {"vec_int_len", reads_args()},
+          {"vec_int_get", checked_read()},
+          {"vec_int_set", nounwind()},
+          {"vec_string_new", allocates()},
+          {"vec_string_push", nounwind()},
+          {"vec_string_len", reads_args()},
+          {"vec_string_get", checked_read()},
+          {"vec_string_set", nounwind()},
+
+          // stdlib functions written in aloha, whose inferred effects are
+          // not carried by their interfaces
+          {"STDIN", pure()},
+          {"STDOUT", pure()},
+          {"STDERR", pure()},
+          {"print", nounwind()},
+          {"println", nounwind()},
+          {"printInt", nounwind()},
+          {"printlnInt", nounwind()},
+          {"printFloat", nounwind()},
+          {"printlnFloat", nounwind()},
+          {"eprint", nounwind()},
+          {"eprintln", nounwind()},
+          {"eprintInt", nounwind()},
+          {"eprintlnInt", nounwind()},
+          {"eprintFloat", nounwind()},
+          {"eprintlnFloat", nounwind()},
+          {"flush", nounwind()},
+          {"input", allocates()},
+          {"assert", nounwind()},
+          {"assert_msg", nounwind()},
+          {"minInt", pure()},
+          {"maxInt", pure()},
+          {"absInt", pure()},
+          {"clampInt", pure()},
+          {"minFloat", pure()},
+          {"maxFloat", pure()},
+          {"absFloat", pure()},
+          {"clampFloat", pure()},
+      };
+    } // namespace
+
+    std::optional<FunctionEffects> runtime_function_effects(std::string_view name)
+    {
+      for (const auto &function : runtime_functions)
+      {
+        if (function.name == name)
+          return function.effects;
+      }
+      return std::nullopt;
+    }
+
+  } // namespace air
+} // namespace aloha
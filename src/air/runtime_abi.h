@@ -0,0 +1,22 @@
+#ifndef AIR_RUNTIME_ABI_H_
+#define AIR_RUNTIME_ABI_H_
+
+#include "stmt.h"
+#include <optional>
+#include <string_view>
+
+namespace aloha
+{
+  namespace air
+  {
+    // Effects of the functions implemented by the C runtime, the stdlib
+    // functions imported through interfaces, and the libc functions codegen
+    // calls directly. Their bodies are never seen when compiling a program,
+    // so these are written down by hand and must be kept in sync with
+    // stdlib/ and stdlib/runtime.
+    std::optional<FunctionEffects> runtime_function_effects(std::string_view name);
+
+  } // namespace air
+} // namespace aloha
+
+#endif // AIR_RUNTIME_ABI_H_
@@ -6,6 +6,7 @@
 #include "../ty/ty.h"
 #include "../frontend/location.h"
 #include <memory>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -104,12 +105,21 @@ namespace aloha
       void accept(AIRVisitor &visitor) override { visitor.visit(this); }
     };
 
+    // which way a branch is expected to go
+    enum class BranchHint
+    {
+      None,
+      Likely,   // the condition is usually true
+      Unlikely, // the condition is usually false
+    };
+
     class If : public Stmt
     {
     public:
       ExprPtr m_condition; // must be TyIds::BOOL
       std::vector<StmtPtr> m_then_branch;
       std::vector<StmtPtr> m_else_branch;
+      BranchHint m_hint = BranchHint::None; // set by BranchHints
 
       If(const Location &loc, ExprPtr condition,
          std::vector<StmtPtr> then_branch, std::vector<StmtPtr> else_branch)
@@ -125,6 +135,8 @@ namespace aloha
       std::string m_enum_name;
       std::string m_variant_name;
       uint32_t m_variant_value;
+      std::optional<IntRange> m_range;
+      std::optional<std::string> m_string;
       std::vector<StmtPtr> m_body;
       Location m_loc;
 
@@ -135,6 +147,15 @@ namespace aloha
             m_variant_name(variant_name), m_variant_value(variant_value),
             m_body(std::move(body)), m_loc(loc) {}
 
+      MatchArm(IntRange range, std::vector<StmtPtr> body, const Location &loc)
+          : m_is_wildcard(false), m_variant_value(0), m_range(range),
+            m_body(std::move(body)), m_loc(loc) {}
+
+      MatchArm(const std::string &string, std::vector<StmtPtr> body,
+               const Location &loc)
+          : m_is_wildcard(false), m_variant_value(0), m_string(string),
+            m_body(std::move(body)), m_loc(loc) {}
+
       MatchArm(std::vector<StmtPtr> body, const Location &loc)
           : m_is_wildcard(true), m_variant_value(0),
             m_body(std::move(body)), m_loc(loc) {}
@@ -165,6 +186,33 @@ namespace aloha
       void accept(AIRVisitor &visitor) override { visitor.visit(this); }
     };
 
+    // A for loop whose variable steps by a constant towards a bound that
+    // does not change inside the loop. Filled in by LoopCanonicalization.
+    struct InductionVar
+    {
+      VarId m_var_id;
+      int64_t m_step;
+      bool m_no_wrap; // stepping past the bound provably cannot overflow
+      std::optional<uint64_t> m_trip_count; // known when start and bound are literals
+    };
+
+    class For : public Stmt
+    {
+    public:
+      StmtPtr m_init;      // VarDecl of the loop variable
+      ExprPtr m_condition; // must be TyIds::BOOL
+      StmtPtr m_increment; // Assignment run after the body and on continue
+      std::vector<StmtPtr> m_body;
+      std::optional<InductionVar> m_induction;
+
+      For(const Location &loc, StmtPtr init, ExprPtr condition, StmtPtr increment,
+          std::vector<StmtPtr> body)
+          : Stmt(loc), m_init(std::move(init)), m_condition(std::move(condition)),
+            m_increment(std::move(increment)), m_body(std::move(body)) {}
+
+      void accept(AIRVisitor &visitor) override { visitor.visit(this); }
+    };
+
     class ExprStmt : public Stmt
     {
     public:
@@ -188,6 +236,31 @@ namespace aloha
           : m_name(name), m_var_id(var_id), m_ty(ty), m_is_mutable(is_mutable), m_loc(loc) {}
     };
 
+    // what calling a function may do, as far as the optimizer is concerned;
+    // the defaults assume nothing and are narrowed by AttributeInference
+    struct FunctionEffects
+    {
+      bool m_reads_memory = true;
+      bool m_writes_memory = true;
+      bool m_arg_memory_only = false; // only touches memory its pointer arguments point to
+      bool m_may_unwind = true;
+      bool m_will_return = false;
+      bool m_no_return = false;
+      bool m_cold = false;
+      bool m_noalias_return = false; // returns fresh memory nothing else points to
+      bool m_nonnull_return = false;
+    };
+
+    // annotations written in the source, e.g. '@inline'
+    struct FunctionAttributes
+    {
+      bool m_always_inline = false;
+      bool m_no_inline = false;
+      bool m_hot = false;
+      bool m_cold = false;
+      bool m_pure = false; // result depends only on the arguments; calls may be merged
+    };
+
     class Function : public Node
     {
     public:
@@ -197,6 +270,11 @@ namespace aloha
       TyId m_return_ty;
       std::vector<StmtPtr> m_body;
       bool m_is_extern;
+      bool m_is_imported = false; // defined by an imported module, may be emitted by several objects
+      bool m_is_foreign = false;  // implemented in C; strings it returns carry no length
+      bool m_is_stdlib = false;   // declared by a stdlib module, through its interface or its source
+      FunctionAttributes m_attributes;
+      FunctionEffects m_effects;
 
       Function(const Location &loc, const std::string &name, FunctionId func_id,
                std::vector<Param> params, TyId return_ty,
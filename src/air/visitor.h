@@ -41,6 +41,7 @@ namespace aloha
       virtual void visit(If *node) = 0;
       virtual void visit(Match *node) = 0;
       virtual void visit(While *node) = 0;
+      virtual void visit(For *node) = 0;
       virtual void visit(ExprStmt *node) = 0;
 
       // declaration visitors
@@ -69,6 +69,21 @@ namespace aloha
             return result;
         }
 
+        std::string LiteralPattern::to_string() const
+        {
+            switch (m_kind)
+            {
+            case Kind::Integer:
+                return std::to_string(m_low);
+            case Kind::Range:
+                return std::to_string(m_low) + (m_inclusive ? "..=" : "..") +
+                       std::to_string(m_high);
+            case Kind::String:
+                return "\"" + m_string + "\"";
+            }
+            return "<pattern>";
+        }
+
         StatementBlock::StatementBlock(Location loc, std::vector<StmtPtr> stmts)
             : Statement(loc), m_statements(std::move(stmts)) {}
 
@@ -106,6 +121,10 @@ namespace aloha
             : m_loc(loc), m_is_wildcard(false), m_pattern(std::move(pattern)),
               m_value(std::move(value)) {}
 
+        MatchExprArm::MatchExprArm(Location loc, LiteralPattern pattern, ExprPtr value)
+            : m_loc(loc), m_is_wildcard(false), m_literal(std::move(pattern)),
+              m_value(std::move(value)) {}
+
         MatchExprArm::MatchExprArm(Location loc, ExprPtr value)
             : m_loc(loc), m_is_wildcard(true), m_value(std::move(value)) {}
 
@@ -171,6 +190,11 @@ namespace aloha
             : m_loc(loc), m_is_wildcard(false), m_pattern(std::move(pattern)),
               m_body(std::move(body)) {}
 
+        MatchArm::MatchArm(Location loc, LiteralPattern pattern,
+                           std::unique_ptr<StatementBlock> body)
+            : m_loc(loc), m_is_wildcard(false), m_literal(std::move(pattern)),
+              m_body(std::move(body)) {}
+
         MatchArm::MatchArm(Location loc, std::unique_ptr<StatementBlock> body)
             : m_loc(loc), m_is_wildcard(true), m_body(std::move(body)) {}
 
@@ -184,7 +208,7 @@ namespace aloha
             : Statement(loc), m_condition(std::move(cond)), m_body(std::move(body)) {}
 
         ForLoop::ForLoop(Location loc, std::unique_ptr<Declaration> init, ExprPtr cond,
-                         std::unique_ptr<Declaration> inc, std::vector<StmtPtr> body)
+                         std::unique_ptr<Assignment> inc, std::unique_ptr<StatementBlock> body)
             : Statement(loc), m_initializer(std::move(init)),
               m_condition(std::move(cond)), m_increment(std::move(inc)),
               m_body(std::move(body)) {}
@@ -207,7 +231,7 @@ namespace aloha
                            bool is_public)
             : Statement(loc), m_name(std::move(func_name)),
               m_parameters(std::move(params)), m_return_type(return_type),
-              m_body(std::move(body)), m_is_extern(is_extern),
+              m_body(std::move(body)), m_is_extern(is_extern), m_is_foreign(is_extern),
               m_is_public(is_public) {}
 
         Function::Function(Location loc, std::unique_ptr<Identifier> func_name,
@@ -217,9 +241,49 @@ namespace aloha
                            bool is_public)
             : Statement(loc), m_name(std::move(func_name)),
               m_parameters(std::move(params)), m_return_type(return_type),
-              m_body(std::move(body)), m_is_extern(is_extern),
+              m_body(std::move(body)), m_is_extern(is_extern), m_is_foreign(is_extern),
               m_is_public(is_public) {}
 
+        bool Function::has_attribute(FunctionAttribute attribute) const
+        {
+            for (FunctionAttribute present : m_attributes)
+            {
+                if (present == attribute)
+                    return true;
+            }
+            return false;
+        }
+
+        const char *function_attribute_name(FunctionAttribute attribute)
+        {
+            switch (attribute)
+            {
+            case FunctionAttribute::Inline:
+                return "inline";
+            case FunctionAttribute::NoInline:
+                return "noinline";
+            case FunctionAttribute::Hot:
+                return "hot";
+            case FunctionAttribute::Cold:
+                return "cold";
+            case FunctionAttribute::Pure:
+                return "pure";
+            }
+            return "<attribute>";
+        }
+
+        std::optional<FunctionAttribute> function_attribute_from_name(std::string_view name)
+        {
+            for (FunctionAttribute attribute : {FunctionAttribute::Inline, FunctionAttribute::NoInline,
+                                                FunctionAttribute::Hot, FunctionAttribute::Cold,
+                                                FunctionAttribute::Pure})
+            {
+                if (name == function_attribute_name(attribute))
+                    return attribute;
+            }
+            return std::nullopt;
+        }
+
         StructField::StructField(std::string name, Type type)
             : m_name(std::move(name)), m_type(type), m_loc(Location()) {}
 
@@ -11,6 +11,7 @@
 #include <optional>
 #include <ostream>
 #include <string>
+#include <string_view>
 #include <vector>
 
 namespace aloha
@@ -66,11 +67,31 @@ namespace aloha
       std::string to_string() const;
     };
 
+    // integer, integer range or string literal used as a match pattern
+    struct LiteralPattern
+    {
+      enum class Kind
+      {
+        Integer,
+        Range,
+        String
+      };
+
+      Kind m_kind;
+      int64_t m_low;     // the integer, or the range start
+      int64_t m_high;    // the range end
+      bool m_inclusive;  // '..=' rather than '..'
+      std::string m_string;
+
+      std::string to_string() const;
+    };
+
     struct MatchPattern
     {
       Location m_loc;
       bool m_is_wildcard;
       std::optional<QualifiedPath> m_path;
+      std::optional<LiteralPattern> m_literal;
     };
 
     class StatementBlock : public Statement
@@ -191,9 +212,11 @@ namespace aloha
       Location m_loc;
       bool m_is_wildcard;
       std::optional<QualifiedPath> m_pattern;
+      std::optional<LiteralPattern> m_literal;
       ExprPtr m_value;
 
       MatchExprArm(Location loc, QualifiedPath pattern, ExprPtr value);
+      MatchExprArm(Location loc, LiteralPattern pattern, ExprPtr value);
       MatchExprArm(Location loc, ExprPtr value);
     };
 
@@ -331,10 +354,13 @@ namespace aloha
       Location m_loc;
       bool m_is_wildcard;
       std::optional<QualifiedPath> m_pattern;
+      std::optional<LiteralPattern> m_literal;
       std::unique_ptr<StatementBlock> m_body;
 
       MatchArm(Location loc, QualifiedPath pattern,
                std::unique_ptr<StatementBlock> body);
+      MatchArm(Location loc, LiteralPattern pattern,
+               std::unique_ptr<StatementBlock> body);
       MatchArm(Location loc, std::unique_ptr<StatementBlock> body);
     };
 
@@ -365,11 +391,11 @@ namespace aloha
     public:
       std::unique_ptr<Declaration> m_initializer;
       ExprPtr m_condition;
-      std::unique_ptr<Declaration> m_increment;
-      std::vector<StmtPtr> m_body;
+      std::unique_ptr<Assignment> m_increment;
+      std::unique_ptr<StatementBlock> m_body;
 
       ForLoop(Location loc, std::unique_ptr<Declaration> init, ExprPtr cond,
-              std::unique_ptr<Declaration> inc, std::vector<StmtPtr> body);
+              std::unique_ptr<Assignment> inc, std::unique_ptr<StatementBlock> body);
       void write(std::ostream &os, unsigned long indent = 0) const override;
       void accept(ASTVisitor &visitor) override;
     };
@@ -387,6 +413,19 @@ namespace aloha
       Parameter(Location loc, std::string name, Type type, std::string type_name);
     };
 
+    // annotation written as '@name' before a function declaration
+    enum class FunctionAttribute
+    {
+      Inline,
+      NoInline,
+      Hot,
+      Cold,
+      Pure
+    };
+
+    const char *function_attribute_name(FunctionAttribute attribute);
+    std::optional<FunctionAttribute> function_attribute_from_name(std::string_view name);
+
     class Function : public Statement
     {
     public:
@@ -395,7 +434,9 @@ namespace aloha
       Type m_return_type;
       std::unique_ptr<StatementBlock> m_body;
       bool m_is_extern;
+      bool m_is_foreign; // implemented outside Aloha; differs from m_is_extern for interface declarations
       bool m_is_public;
+      std::vector<FunctionAttribute> m_attributes;
 
       Function(Location loc, std::unique_ptr<Identifier> func_name,
                std::vector<Parameter> params, Type return_type,
@@ -405,6 +446,7 @@ namespace aloha
                std::vector<Parameter> params, Type return_type, std::string return_type_name,
                std::unique_ptr<StatementBlock> body, bool is_extern = false,
                bool is_public = false);
+      bool has_attribute(FunctionAttribute attribute) const;
       void write(std::ostream &os, unsigned long indent = 0) const override;
       void accept(ASTVisitor &visitor) override;
     };
@@ -102,7 +102,9 @@ namespace aloha
             for (const auto &arm : m_arms)
             {
                 os << std::string(indent + 4, ' ')
-                   << (arm.m_is_wildcard ? "_" : arm.m_pattern->to_string())
+                   << (arm.m_is_wildcard ? "_"
+                       : arm.m_literal     ? arm.m_literal->to_string()
+                                           : arm.m_pattern->to_string())
                    << " =>\n";
                 arm.m_value->write(os, indent + 6);
             }
@@ -237,7 +239,9 @@ namespace aloha
             for (const auto &arm : m_arms)
             {
                 os << std::string(indent + 4, ' ')
-                   << (arm.m_is_wildcard ? "_" : arm.m_pattern->to_string())
+                   << (arm.m_is_wildcard ? "_"
+                       : arm.m_literal     ? arm.m_literal->to_string()
+                                           : arm.m_pattern->to_string())
                    << " => {\n";
                 arm.m_body->write(os, indent + 6);
                 os << std::string(indent + 4, ' ') << "}\n";
@@ -271,10 +275,7 @@ namespace aloha
             m_increment->write(os, indent + 4);
             os << std::string(indent + 2, ' ') << "}\n";
             os << std::string(indent + 2, ' ') << "Body:{\n";
-            for (const auto &stmt : m_body)
-            {
-                stmt->write(os, indent + 4);
-            }
+            m_body->write(os, indent + 4);
             os << std::string(indent + 2, ' ') << "}\n";
             os << std::string(indent, ' ') << "}\n";
         }
@@ -284,6 +285,13 @@ namespace aloha
             os << std::string(indent, ' ') << "Function:{\n";
             os << std::string(indent + 2, ' ') << "Public: "
                << (m_is_public ? "true" : "false") << "\n";
+            if (!m_attributes.empty())
+            {
+                os << std::string(indent + 2, ' ') << "Attributes:";
+                for (FunctionAttribute attribute : m_attributes)
+                    os << " @" << function_attribute_name(attribute);
+                os << "\n";
+            }
             os << std::string(indent + 2, ' ') << "Name: ";
             m_name->write(os, 0);
             os << std::string(indent + 2, ' ') << "Parameters:[\n";
@@ -0,0 +1,72 @@
+#include "codegen.h"
+#include "../air/runtime_abi.h"
+#include <llvm/IR/Attributes.h>
+#include <llvm/IR/Function.h>
+#include <unordered_set>
+
+namespace aloha
+{
+  void CodeGenerator::apply_function_effects(llvm::Function *llvm_func, const air::FunctionEffects &effects)
+  {
+    if (!effects.m_reads_memory && !effects.m_writes_memory)
+    {
+      llvm_func->setDoesNotAccessMemory();
+    }
+    else
+    {
+      if (!effects.m_writes_memory)
+        llvm_func->setOnlyReadsMemory();
+      if (effects.m_arg_memory_only)
+        llvm_func->setOnlyAccessesArgMemory();
+    }
+
+    if (!effects.m_may_unwind)
+      llvm_func->setDoesNotThrow();
+    if (effects.m_will_return)
+      llvm_func->addFnAttr(llvm::Attribute::WillReturn);
+    if (effects.m_no_return)
+      llvm_func->setDoesNotReturn();
+    if (effects.m_cold)
+      llvm_func->addFnAttr(llvm::Attribute::Cold);
+
+    if (llvm_func->getReturnType()->isPointerTy())
+    {
+      if (effects.m_noalias_return)
+        llvm_func->addRetAttr(llvm::Attribute::NoAlias);
+      if (effects.m_nonnull_return)
+        llvm_func->addRetAttr(llvm::Attribute::NonNull);
+    }
+  }
+
+  void CodeGenerator::apply_source_attributes(llvm::Function *llvm_func, const air::Function &func)
+  {
+    // @pure and @cold reach LLVM through the effects AttributeInference
+    // derives from them; inlining hints only matter where there is a body.
+    // Functions of precompiled modules, the stdlib's @inline ones included,
+    // get theirs from the bitcode -O links in for them
+    const air::FunctionAttributes &attributes = func.m_attributes;
+    if (attributes.m_always_inline && !func.m_is_extern)
+      llvm_func->addFnAttr(llvm::Attribute::AlwaysInline);
+    if (attributes.m_no_inline && !func.m_is_extern)
+      llvm_func->addFnAttr(llvm::Attribute::NoInline);
+    if (attributes.m_hot)
+      llvm_func->addFnAttr(llvm::Attribute::Hot);
+  }
+
+  void CodeGenerator::annotate_runtime_declarations()
+  {
+    // functions declared from AIR already carry their (possibly narrower) effects
+    std::unordered_set<const llvm::Function *> from_air;
+    for (const auto &[func_id, llvm_func] : function_map)
+      from_air.insert(llvm_func);
+
+    for (llvm::Function &llvm_func : *module)
+    {
+      if (!llvm_func.isDeclaration() || from_air.count(&llvm_func))
+        continue;
+      if (auto effects = air::runtime_function_effects(llvm_func.getName().str()))
+        apply_function_effects(&llvm_func, *effects);
+    }
+  }
+
+} // namespace aloha
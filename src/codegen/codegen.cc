@@ -4,7 +4,10 @@
 #include <llvm/IR/Function.h>
 #include <llvm/IR/Type.h>
 #include <llvm/IR/Verifier.h>
+#include <algorithm>
 #include <iostream>
+#include <unordered_set>
+#include "../air/runtime_abi.h"
 #include "../error/internal.h"
 
 namespace aloha
@@ -41,6 +44,9 @@ namespace aloha
     // wrap the main function with a custom entry point
     generate_main_wrapper();
 
+    // runtime functions codegen called without an AIR declaration
+    annotate_runtime_declarations();
+
     if (has_errors())
     {
       return nullptr;
@@ -179,9 +185,11 @@ namespace aloha
         continue;
       }
 
-      llvm::Function::LinkageTypes linkage = func->m_is_extern
+      // imported definitions may also be present in separately compiled
+      // modules, so let the linker merge identical copies
+      llvm::Function::LinkageTypes linkage = func->m_is_extern || !func->m_is_imported
                                                  ? llvm::Function::ExternalLinkage
-                                                 : llvm::Function::ExternalLinkage;
+                                                 : llvm::Function::WeakODRLinkage;
 
       std::string llvm_name = func->m_name;
       if (llvm_name == "main")
@@ -204,6 +212,14 @@ namespace aloha
       }
 
       function_map[func->m_func_id] = llvm_func;
+      apply_function_effects(llvm_func, func->m_effects);
+      apply_source_attributes(llvm_func, *func);
+      register_runtime_intrinsic(func.get());
+
+      // the runtime builds its strings with the header already
+      if (func->m_is_foreign && func->m_return_ty == TyIds::STRING &&
+          !air::runtime_function_effects(func->m_name))
+        foreign_string_returns.insert(func->m_func_id);
     }
   }
 
@@ -405,7 +421,17 @@ namespace aloha
 
   void CodeGenerator::visit(air::StringLiteral *node)
   {
-    llvm::Constant *str_constant = llvm::ConstantDataArray::getString(*context, node->m_value);
+    current_value = create_string_constant(node->m_value);
+  }
+
+  llvm::Constant *CodeGenerator::create_string_constant(const std::string &value)
+  {
+    // laid out like aloha_string_header in stdlib/runtime/runtime.h: the
+    // length, then the NUL-terminated bytes the string points at
+    llvm::Type *i64_ty = llvm::Type::getInt64Ty(*context);
+    llvm::Constant *bytes = llvm::ConstantDataArray::getString(*context, value);
+    llvm::Constant *str_constant = llvm::ConstantStruct::getAnon(
+        {llvm::ConstantInt::get(i64_ty, value.size()), bytes});
     llvm::GlobalVariable *global_str = new llvm::GlobalVariable(
         *module,
         str_constant->getType(),
@@ -413,10 +439,12 @@ namespace aloha
         llvm::GlobalValue::PrivateLinkage,
         str_constant,
         ".str");
+    global_str->setAlignment(llvm::Align(8));
 
     llvm::Constant *zero = llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), 0);
-    std::vector<llvm::Constant *> indices = {zero, zero};
-    current_value = llvm::ConstantExpr::getGetElementPtr(
+    llvm::Constant *one = llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), 1);
+    std::vector<llvm::Constant *> indices = {zero, one, zero};
+    return llvm::ConstantExpr::getInBoundsGetElementPtr(
         str_constant->getType(), global_str, indices);
   }
 
@@ -471,38 +499,34 @@ namespace aloha
     llvm::BasicBlock *merge_block = llvm::BasicBlock::Create(*context, "match.expr.end");
     std::vector<std::pair<llvm::Value *, llvm::BasicBlock *>> incoming;
 
-    for (size_t i = 0; i < node->m_arms.size(); ++i)
+    llvm::BasicBlock *default_block = nullptr;
+    if (!node->m_arms.empty() && node->m_arms.back().m_is_wildcard)
     {
-      const auto &arm = node->m_arms[i];
-      llvm::BasicBlock *arm_block = llvm::BasicBlock::Create(*context, "match.expr.arm", current_function);
-      llvm::BasicBlock *next_block = nullptr;
-      bool is_last = i + 1 == node->m_arms.size();
-
-      if (arm.m_is_wildcard || is_last)
-      {
-        next_block = merge_block;
-      }
-      else
-      {
-        next_block = llvm::BasicBlock::Create(*context, "match.expr.next");
-      }
+      default_block = llvm::BasicBlock::Create(*context, "match.expr.default", current_function);
+    }
+    else
+    {
+      default_block = create_unreachable_block("match.expr.unreachable");
+    }
 
-      llvm::BasicBlock *current_block = builder->GetInsertBlock();
-      if (current_block && !current_block->getTerminator())
+    std::vector<llvm::BasicBlock *> arm_blocks;
+    std::vector<MatchCase> cases;
+    for (const auto &arm : node->m_arms)
+    {
+      if (arm.m_is_wildcard)
       {
-        if (arm.m_is_wildcard || is_last)
-        {
-          builder->CreateBr(arm_block);
-        }
-        else
-        {
-          llvm::Value *tag = llvm::ConstantInt::get(scrutinee->getType(), arm.m_variant_value);
-          llvm::Value *cond = builder->CreateICmpEQ(scrutinee, tag, "matchexprcmp");
-          builder->CreateCondBr(cond, arm_block, next_block);
-        }
+        arm_blocks.push_back(default_block);
+        continue;
       }
+      arm_blocks.push_back(llvm::BasicBlock::Create(*context, "match.expr.arm", current_function));
+      cases.push_back({arm.m_variant_value, arm.m_range, arm.m_string, arm_blocks.back()});
+    }
+    emit_match_dispatch(scrutinee, cases, default_block);
 
-      builder->SetInsertPoint(arm_block);
+    for (size_t i = 0; i < node->m_arms.size(); ++i)
+    {
+      const auto &arm = node->m_arms[i];
+      builder->SetInsertPoint(arm_blocks[i]);
       arm.m_value->accept(*this);
       llvm::Value *arm_value = current_value;
       if (!arm_value)
@@ -517,12 +541,6 @@ namespace aloha
         builder->CreateBr(merge_block);
         incoming.emplace_back(arm_value, arm_end_block);
       }
-
-      if (next_block != merge_block)
-      {
-        next_block->insertInto(current_function);
-        builder->SetInsertPoint(next_block);
-      }
     }
 
     merge_block->insertInto(current_function);
@@ -679,13 +697,7 @@ namespace aloha
     case air::BinaryOpKind::EQ:
       if (node->m_left->m_ty == TyIds::STRING)
       {
-        llvm::FunctionCallee str_eq_func = module->getOrInsertFunction(
-            "aloha_sys_str_eq",
-            llvm::FunctionType::get(llvm::Type::getInt1Ty(*context),
-                                    {llvm::PointerType::get(*context, 0),
-                                     llvm::PointerType::get(*context, 0)},
-                                    false));
-        current_value = builder->CreateCall(str_eq_func, {left, right}, "streqtmp");
+        current_value = create_string_equality(left, right);
       }
       else if (kind == NumericKind::INTEGER || kind == NumericKind::BOOL ||
           left->getType()->isIntegerTy())
@@ -705,13 +717,7 @@ namespace aloha
     case air::BinaryOpKind::NE:
       if (node->m_left->m_ty == TyIds::STRING)
       {
-        llvm::FunctionCallee str_eq_func = module->getOrInsertFunction(
-            "aloha_sys_str_eq",
-            llvm::FunctionType::get(llvm::Type::getInt1Ty(*context),
-                                    {llvm::PointerType::get(*context, 0),
-                                     llvm::PointerType::get(*context, 0)},
-                                    false));
-        llvm::Value *eq = builder->CreateCall(str_eq_func, {left, right}, "streqtmp");
+        llvm::Value *eq = create_string_equality(left, right);
         current_value = builder->CreateNot(eq, "strnetmp");
       }
       else if (kind == NumericKind::INTEGER || kind == NumericKind::BOOL ||
@@ -837,6 +843,13 @@ namespace aloha
       args.push_back(current_value);
     }
 
+    auto intrinsic = runtime_intrinsics.find(node->m_func_id);
+    if (intrinsic != runtime_intrinsics.end())
+    {
+      current_value = emit_runtime_intrinsic(intrinsic->second, callee, args);
+      return;
+    }
+
     if (callee->getReturnType()->isVoidTy())
     {
       current_value = builder->CreateCall(callee, args);
@@ -845,6 +858,13 @@ namespace aloha
     {
       current_value = builder->CreateCall(callee, args, "calltmp");
     }
+
+    if (foreign_string_returns.count(node->m_func_id))
+    {
+      llvm::Type *ptr_ty = llvm::PointerType::get(*context, 0);
+      llvm::FunctionCallee from_cstr = module->getOrInsertFunction("aloha_string_from_cstr", ptr_ty, ptr_ty);
+      current_value = builder->CreateCall(from_cstr, {current_value}, "str.fromc");
+    }
   }
 
   void CodeGenerator::visit(air::StructInstantiation *node)
@@ -857,7 +877,7 @@ namespace aloha
       return;
     }
 
-    llvm::AllocaInst *struct_alloca = builder->CreateAlloca(struct_type, nullptr, "struct_tmp");
+    llvm::AllocaInst *struct_alloca = create_entry_block_alloca(builder->GetInsertBlock()->getParent(), "struct_tmp", struct_type);
 
     for (size_t i = 0; i < node->m_field_values.size(); ++i)
     {
@@ -896,16 +916,18 @@ namespace aloha
       return;
     }
 
-    llvm::FunctionCallee alloc_func = module->getOrInsertFunction(
-        "aloha_arena_alloc",
-        llvm::PointerType::get(*context, 0),
-        llvm::PointerType::get(*context, 0),
-        llvm::Type::getInt64Ty(*context));
-
-    const llvm::DataLayout &layout = module->getDataLayout();
-    uint64_t struct_size = layout.getTypeAllocSize(struct_type);
-    llvm::Value *size = llvm::ConstantInt::get(llvm::Type::getInt64Ty(*context), struct_size);
-    llvm::Value *struct_ptr = builder->CreateCall(alloc_func, {arena, size}, "newobject");
+    llvm::Value *struct_ptr = nullptr;
+    if (node->m_stack_allocated)
+    {
+      // escape analysis proved the object dies with the function; SROA can
+      // then split it into scalars
+      struct_ptr = create_entry_block_alloca(current_function, "stackobject", struct_type);
+    }
+    else
+    {
+      const llvm::DataLayout &layout = module->getDataLayout();
+      struct_ptr = create_arena_alloc(arena, layout.getTypeAllocSize(struct_type));
+    }
 
     for (size_t i = 0; i < node->m_field_values.size(); ++i)
     {
@@ -985,7 +1007,7 @@ namespace aloha
         return;
       }
 
-      llvm::AllocaInst *tmp_alloca = builder->CreateAlloca(struct_type, nullptr, "tmp_struct");
+      llvm::AllocaInst *tmp_alloca = create_entry_block_alloca(builder->GetInsertBlock()->getParent(), "tmp_struct", struct_type);
       builder->CreateStore(object, tmp_alloca);
       struct_ptr = tmp_alloca;
     }
@@ -1270,7 +1292,7 @@ namespace aloha
         return;
       }
 
-      llvm::AllocaInst *tmp_alloca = builder->CreateAlloca(struct_type, nullptr, "tmp_struct");
+      llvm::AllocaInst *tmp_alloca = create_entry_block_alloca(builder->GetInsertBlock()->getParent(), "tmp_struct", struct_type);
       builder->CreateStore(object, tmp_alloca);
       struct_ptr = tmp_alloca;
     }
@@ -1313,14 +1335,15 @@ namespace aloha
     llvm::BasicBlock *merge_block = llvm::BasicBlock::Create(*context, "ifcont");
     llvm::BasicBlock *else_block = nullptr;
 
+    llvm::MDNode *weights = branch_weights(node->m_hint);
     if (node->m_else_branch.empty())
     {
-      builder->CreateCondBr(cond, then_block, merge_block);
+      builder->CreateCondBr(cond, then_block, merge_block, weights);
     }
     else
     {
       else_block = llvm::BasicBlock::Create(*context, "else");
-      builder->CreateCondBr(cond, then_block, else_block);
+      builder->CreateCondBr(cond, then_block, else_block, weights);
     }
 
     builder->SetInsertPoint(then_block);
@@ -1393,42 +1416,36 @@ namespace aloha
     llvm::BasicBlock *merge_block = llvm::BasicBlock::Create(*context, "match.end");
     bool merge_reachable = false;
 
-    for (size_t i = 0; i < node->m_arms.size(); ++i)
+    // the builder only accepts matches that are exhaustive or end in a
+    // wildcard, so without one the default can never be taken
+    llvm::BasicBlock *default_block = nullptr;
+    if (!node->m_arms.empty() && node->m_arms.back().m_is_wildcard)
     {
-      const auto &arm = node->m_arms[i];
-      llvm::BasicBlock *arm_block = llvm::BasicBlock::Create(*context, "match.arm", current_function);
-      llvm::BasicBlock *next_block = nullptr;
-      bool is_last = i + 1 == node->m_arms.size();
-
-      if (!arm.m_is_wildcard && !is_last)
-      {
-        next_block = llvm::BasicBlock::Create(*context, "match.next");
-      }
-      else
-      {
-        next_block = merge_block;
-      }
+      default_block = llvm::BasicBlock::Create(*context, "match.default", current_function);
+    }
+    else
+    {
+      default_block = create_unreachable_block("match.unreachable");
+    }
 
-      llvm::BasicBlock *current_block = builder->GetInsertBlock();
-      if (current_block && !current_block->getTerminator())
+    std::vector<llvm::BasicBlock *> arm_blocks;
+    std::vector<MatchCase> cases;
+    for (const auto &arm : node->m_arms)
+    {
+      if (arm.m_is_wildcard)
       {
-        if (arm.m_is_wildcard)
-        {
-          builder->CreateBr(arm_block);
-        }
-        else
-        {
-          llvm::Value *tag = llvm::ConstantInt::get(scrutinee->getType(), arm.m_variant_value);
-          llvm::Value *cond = builder->CreateICmpEQ(scrutinee, tag, "matchcmp");
-          builder->CreateCondBr(cond, arm_block, next_block);
-          if (next_block == merge_block)
-          {
-            merge_reachable = true;
-          }
-        }
+        arm_blocks.push_back(default_block);
+        continue;
       }
+      arm_blocks.push_back(llvm::BasicBlock::Create(*context, "match.arm", current_function));
+      cases.push_back({arm.m_variant_value, arm.m_range, arm.m_string, arm_blocks.back()});
+    }
+    emit_match_dispatch(scrutinee, cases, default_block);
 
-      builder->SetInsertPoint(arm_block);
+    for (size_t i = 0; i < node->m_arms.size(); ++i)
+    {
+      const auto &arm = node->m_arms[i];
+      builder->SetInsertPoint(arm_blocks[i]);
       for (const auto &stmt : arm.m_body)
       {
         llvm::BasicBlock *block = builder->GetInsertBlock();
@@ -1445,12 +1462,6 @@ namespace aloha
         builder->CreateBr(merge_block);
         merge_reachable = true;
       }
-
-      if (next_block != merge_block)
-      {
-        next_block->insertInto(current_function);
-        builder->SetInsertPoint(next_block);
-      }
     }
 
     if (merge_reachable)
@@ -1465,6 +1476,255 @@ namespace aloha
     }
   }
 
+  llvm::BasicBlock *CodeGenerator::create_unreachable_block(const std::string &name)
+  {
+    llvm::BasicBlock *saved_block = builder->GetInsertBlock();
+    llvm::BasicBlock *block = llvm::BasicBlock::Create(*context, name, current_function);
+    builder->SetInsertPoint(block);
+    builder->CreateUnreachable();
+    builder->SetInsertPoint(saved_block);
+    return block;
+  }
+
+  namespace
+  {
+    // ranges up to this many values become individual switch cases; wider
+    // ones are tested with a subtract and unsigned compare
+    constexpr uint64_t MAX_SWITCH_RANGE = 64;
+
+    constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ULL;
+    constexpr uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+    // FNV-1a over the string, seeded, with the high half folded in so that
+    // masking keeps bits that depend on every byte. The generated code in
+    // emit_string_dispatch computes the same function.
+    uint64_t string_pattern_hash(const std::string &value, uint64_t seed)
+    {
+      uint64_t hash = FNV_OFFSET ^ seed;
+      for (unsigned char c : value)
+      {
+        hash = (hash ^ c) * FNV_PRIME;
+      }
+      return hash ^ (hash >> 32);
+    }
+
+    struct PerfectHash
+    {
+      uint64_t seed;
+      uint64_t mask;
+    };
+
+    // searches for a seed under which every key lands in its own slot,
+    // preferring the smallest table so the switch stays dense
+    PerfectHash find_perfect_hash(const std::vector<std::string> &keys)
+    {
+      constexpr uint64_t SEEDS_PER_SIZE = 256;
+
+      uint64_t table_size = 1;
+      while (table_size < keys.size())
+      {
+        table_size <<= 1;
+      }
+
+      for (; table_size <= (1ULL << 32); table_size <<= 1)
+      {
+        uint64_t mask = table_size - 1;
+        for (uint64_t seed = 0; seed < SEEDS_PER_SIZE; ++seed)
+        {
+          std::unordered_set<uint64_t> slots;
+          bool collision = false;
+          for (const auto &key : keys)
+          {
+            if (!slots.insert(string_pattern_hash(key, seed) & mask).second)
+            {
+              collision = true;
+              break;
+            }
+          }
+          if (!collision)
+          {
+            return {seed, mask};
+          }
+        }
+      }
+
+      // only reachable if distinct keys collide in 32 bits under every seed
+      ALOHA_ICE("no perfect hash found for string match patterns");
+    }
+  } // namespace
+
+  void CodeGenerator::emit_match_dispatch(llvm::Value *scrutinee,
+                                          const std::vector<MatchCase> &cases,
+                                          llvm::BasicBlock *default_block)
+  {
+    bool is_string = std::any_of(cases.begin(), cases.end(),
+                                 [](const MatchCase &c)
+                                 { return c.string.has_value(); });
+    if (is_string)
+    {
+      emit_string_dispatch(scrutinee, cases, default_block);
+      return;
+    }
+
+    auto *int_ty = llvm::cast<llvm::IntegerType>(scrutinee->getType());
+    auto case_value = [&](uint64_t value)
+    { return llvm::ConstantInt::get(int_ty, value); };
+
+    // wide ranges are tested after the switch misses; the builder rejects
+    // overlapping patterns, so the order of the tests does not matter
+    std::vector<const MatchCase *> wide_ranges;
+    unsigned case_count = 0;
+    for (const auto &match_case : cases)
+    {
+      if (match_case.range.has_value())
+      {
+        uint64_t width = static_cast<uint64_t>(match_case.range->m_high) -
+                         static_cast<uint64_t>(match_case.range->m_low);
+        if (width >= MAX_SWITCH_RANGE)
+        {
+          wide_ranges.push_back(&match_case);
+          continue;
+        }
+        case_count += static_cast<unsigned>(width + 1);
+      }
+      else
+      {
+        ++case_count;
+      }
+    }
+
+    llvm::BasicBlock *switch_default = default_block;
+    if (!wide_ranges.empty())
+    {
+      switch_default = llvm::BasicBlock::Create(*context, "match.range", current_function);
+    }
+
+    llvm::SwitchInst *dispatch = builder->CreateSwitch(scrutinee, switch_default, case_count);
+    for (const auto &match_case : cases)
+    {
+      if (!match_case.range.has_value())
+      {
+        dispatch->addCase(case_value(match_case.variant_value), match_case.block);
+        continue;
+      }
+
+      uint64_t low = static_cast<uint64_t>(match_case.range->m_low);
+      uint64_t width = static_cast<uint64_t>(match_case.range->m_high) - low;
+      if (width >= MAX_SWITCH_RANGE)
+      {
+        continue;
+      }
+      for (uint64_t offset = 0; offset <= width; ++offset)
+      {
+        dispatch->addCase(case_value(low + offset), match_case.block);
+      }
+    }
+
+    for (size_t i = 0; i < wide_ranges.size(); ++i)
+    {
+      const MatchCase &match_case = *wide_ranges[i];
+      builder->SetInsertPoint(switch_default);
+
+      llvm::BasicBlock *next = default_block;
+      if (i + 1 < wide_ranges.size())
+      {
+        next = llvm::BasicBlock::Create(*context, "match.range", current_function);
+      }
+
+      uint64_t low = static_cast<uint64_t>(match_case.range->m_low);
+      uint64_t width = static_cast<uint64_t>(match_case.range->m_high) - low;
+      llvm::Value *offset = builder->CreateSub(scrutinee, case_value(low), "rangeoffset");
+      llvm::Value *in_range = builder->CreateICmpULE(offset, case_value(width), "inrange");
+      builder->CreateCondBr(in_range, match_case.block, next);
+      switch_default = next;
+    }
+  }
+
+  void CodeGenerator::emit_string_dispatch(llvm::Value *scrutinee,
+                                           const std::vector<MatchCase> &cases,
+                                           llvm::BasicBlock *default_block)
+  {
+    std::vector<std::string> keys;
+    for (const auto &match_case : cases)
+    {
+      keys.push_back(match_case.string.value());
+    }
+    PerfectHash perfect_hash = find_perfect_hash(keys);
+
+    llvm::Type *i8_ty = llvm::Type::getInt8Ty(*context);
+    llvm::IntegerType *i64_ty = llvm::Type::getInt64Ty(*context);
+    auto i64 = [&](uint64_t value)
+    { return llvm::ConstantInt::get(i64_ty, value); };
+
+    // a null string, like input() at the end of the input, matches no
+    // pattern; anything else is hashed over exactly its stored length
+    llvm::BasicBlock *measure_block = llvm::BasicBlock::Create(*context, "match.str.len", current_function);
+    llvm::BasicBlock *loop_block = llvm::BasicBlock::Create(*context, "match.str.hash", current_function);
+    llvm::BasicBlock *done_block = llvm::BasicBlock::Create(*context, "match.str.dispatch", current_function);
+    builder->CreateCondBr(builder->CreateIsNull(scrutinee, "strnull"), default_block, measure_block);
+
+    builder->SetInsertPoint(measure_block);
+    llvm::Value *length = load_string_length(scrutinee);
+    builder->CreateCondBr(builder->CreateICmpEQ(length, i64(0), "strempty"), done_block, loop_block);
+
+    builder->SetInsertPoint(loop_block);
+    llvm::PHINode *index = builder->CreatePHI(i64_ty, 2, "strindex");
+    llvm::PHINode *running_hash = builder->CreatePHI(i64_ty, 2, "strrunhash");
+    index->addIncoming(i64(0), measure_block);
+    running_hash->addIncoming(i64(FNV_OFFSET ^ perfect_hash.seed), measure_block);
+    llvm::Value *byte_ptr = builder->CreateGEP(i8_ty, scrutinee, index, "strbyteptr");
+    llvm::Value *byte = builder->CreateLoad(i8_ty, byte_ptr, "strbyte");
+    llvm::Value *mixed = builder->CreateXor(running_hash, builder->CreateZExt(byte, i64_ty), "strmix");
+    llvm::Value *next_hash = builder->CreateMul(mixed, i64(FNV_PRIME), "strnexthash");
+    llvm::Value *next_index = builder->CreateAdd(index, i64(1), "strnextindex");
+    index->addIncoming(next_index, loop_block);
+    running_hash->addIncoming(next_hash, loop_block);
+    builder->CreateCondBr(builder->CreateICmpULT(next_index, length, "strmore"), loop_block, done_block);
+
+    builder->SetInsertPoint(done_block);
+    llvm::PHINode *hash = builder->CreatePHI(i64_ty, 2, "strhash");
+    hash->addIncoming(i64(FNV_OFFSET ^ perfect_hash.seed), measure_block);
+    hash->addIncoming(next_hash, loop_block);
+    llvm::Value *folded = builder->CreateXor(hash, builder->CreateLShr(hash, i64(32)), "strfold");
+    llvm::Value *slot = builder->CreateAnd(folded, i64(perfect_hash.mask), "strslot");
+    llvm::SwitchInst *dispatch = builder->CreateSwitch(slot, default_block,
+                                                       static_cast<unsigned>(cases.size()));
+
+    llvm::FunctionCallee memcmp_func = module->getOrInsertFunction(
+        "memcmp",
+        llvm::FunctionType::get(llvm::Type::getInt32Ty(*context),
+                                {llvm::PointerType::get(*context, 0),
+                                 llvm::PointerType::get(*context, 0), i64_ty},
+                                false));
+
+    // a slot only proves the scrutinee may equal its key
+    for (const auto &match_case : cases)
+    {
+      const std::string &key = match_case.string.value();
+      llvm::BasicBlock *check_block = llvm::BasicBlock::Create(*context, "match.str.check", current_function);
+      dispatch->addCase(i64(string_pattern_hash(key, perfect_hash.seed) & perfect_hash.mask),
+                        check_block);
+
+      builder->SetInsertPoint(check_block);
+      llvm::Value *same_length = builder->CreateICmpEQ(length, i64(key.size()), "strlenmatch");
+      if (key.empty())
+      {
+        builder->CreateCondBr(same_length, match_case.block, default_block);
+        continue;
+      }
+
+      llvm::BasicBlock *compare_block = llvm::BasicBlock::Create(*context, "match.str.compare", current_function);
+      builder->CreateCondBr(same_length, compare_block, default_block);
+
+      builder->SetInsertPoint(compare_block);
+      llvm::Value *cmp = builder->CreateCall(memcmp_func, {scrutinee, create_string_constant(key), i64(key.size())},
+                                             "strcmp");
+      llvm::Value *equal = builder->CreateICmpEQ(cmp, llvm::ConstantInt::get(llvm::Type::getInt32Ty(*context), 0),
+                                                 "strmatch");
+      builder->CreateCondBr(equal, match_case.block, default_block);
+    }
+  }
+
   void CodeGenerator::visit(air::Break *node)
   {
     if (break_blocks.empty())
@@ -1536,6 +1796,95 @@ namespace aloha
     builder->SetInsertPoint(after_block);
   }
 
+  void CodeGenerator::visit(air::For *node)
+  {
+    node->m_init->accept(*this);
+
+    llvm::BasicBlock *condition_block =
+        llvm::BasicBlock::Create(*context, "for.cond", current_function);
+    llvm::BasicBlock *body_block =
+        llvm::BasicBlock::Create(*context, "for.body");
+    llvm::BasicBlock *increment_block =
+        llvm::BasicBlock::Create(*context, "for.inc");
+    llvm::BasicBlock *after_block =
+        llvm::BasicBlock::Create(*context, "for.end");
+
+    builder->CreateBr(condition_block);
+
+    builder->SetInsertPoint(condition_block);
+    node->m_condition->accept(*this);
+    llvm::Value *cond = current_value;
+    if (!cond)
+    {
+      report_error("Failed to generate for condition", node->m_loc);
+      return;
+    }
+    builder->CreateCondBr(cond, body_block, after_block);
+
+    body_block->insertInto(current_function);
+    builder->SetInsertPoint(body_block);
+    break_blocks.push_back(after_block);
+    continue_blocks.push_back(increment_block);
+
+    for (const auto &stmt : node->m_body)
+    {
+      llvm::BasicBlock *block = builder->GetInsertBlock();
+      if (!block || block->getTerminator())
+      {
+        break;
+      }
+      stmt->accept(*this);
+    }
+
+    break_blocks.pop_back();
+    continue_blocks.pop_back();
+
+    llvm::BasicBlock *body_end_block = builder->GetInsertBlock();
+    if (body_end_block && !body_end_block->getTerminator())
+    {
+      builder->CreateBr(increment_block);
+    }
+
+    increment_block->insertInto(current_function);
+    builder->SetInsertPoint(increment_block);
+    if (node->m_induction && node->m_induction->m_no_wrap)
+    {
+      // the step cannot overflow, which lets scalar evolution compute the
+      // trip count for any stride
+      auto it = variable_map.find(node->m_induction->m_var_id);
+      if (it == variable_map.end())
+      {
+        report_error("For loop variable has no storage", node->m_loc);
+        return;
+      }
+      llvm::Type *int_ty = llvm::Type::getInt64Ty(*context);
+      llvm::Value *current = builder->CreateLoad(int_ty, it->second, "for.iv");
+      llvm::Value *next = builder->CreateNSWAdd(
+          current, llvm::ConstantInt::get(int_ty, static_cast<uint64_t>(node->m_induction->m_step), true),
+          "for.iv.next");
+      builder->CreateStore(next, it->second);
+    }
+    else
+    {
+      node->m_increment->accept(*this);
+    }
+    llvm::BranchInst *latch = builder->CreateBr(condition_block);
+
+    // a loop that provably finishes may be assumed to make progress, which
+    // lets the vectorizer and unroller treat it as a counted loop
+    if (node->m_induction && node->m_induction->m_no_wrap)
+    {
+      llvm::MDNode *progress =
+          llvm::MDNode::get(*context, llvm::MDString::get(*context, "llvm.loop.mustprogress"));
+      llvm::MDNode *loop_id = llvm::MDNode::getDistinct(*context, {nullptr, progress});
+      loop_id->replaceOperandWith(0, loop_id);
+      latch->setMetadata(llvm::LLVMContext::MD_loop, loop_id);
+    }
+
+    after_block->insertInto(current_function);
+    builder->SetInsertPoint(after_block);
+  }
+
   void CodeGenerator::visit(air::ExprStmt *node)
   {
     node->m_expression->accept(*this);
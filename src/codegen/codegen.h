@@ -15,8 +15,10 @@
 
 #include <iostream>
 #include <memory>
+#include <optional>
 #include <string>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace aloha
@@ -43,6 +45,29 @@ namespace aloha
     // Function mapping: FunctionId -> LLVM Function*
     std::unordered_map<FunctionId, llvm::Function *> function_map;
 
+    // stdlib calls whose common case is emitted inline; the runtime function
+    // is still called on the slow path (growth, failed bounds checks, null)
+    enum class RuntimeIntrinsic
+    {
+      VecLen,
+      VecGet,
+      VecSet,
+      VecPush,
+      StringLen,
+      StringCharAt,
+      ExpectTrue,  // likely(), where it is not the condition of an if
+      ExpectFalse, // unlikely()
+    };
+    std::unordered_map<FunctionId, RuntimeIntrinsic> runtime_intrinsics;
+
+    // C functions returning strings without the length header Aloha
+    // strings carry; their results are copied into Aloha strings
+    std::unordered_set<FunctionId> foreign_string_returns;
+
+    // same weights clang uses for __builtin_expect
+    static constexpr uint32_t LIKELY_WEIGHT = 2000;
+    static constexpr uint32_t UNLIKELY_WEIGHT = 1;
+
     // Variable mapping: VarId -> LLVM AllocaInst*
     std::unordered_map<VarId, llvm::AllocaInst *> variable_map;
 
@@ -71,6 +96,21 @@ namespace aloha
 
     void declare_functions();
     llvm::FunctionType *get_function_type(air::Function *func);
+    void register_runtime_intrinsic(air::Function *func);
+    void apply_function_effects(llvm::Function *llvm_func, const air::FunctionEffects &effects);
+    void apply_source_attributes(llvm::Function *llvm_func, const air::Function &func);
+    void annotate_runtime_declarations();
+    llvm::Value *emit_runtime_intrinsic(RuntimeIntrinsic intrinsic, llvm::Function *callee,
+                                        const std::vector<llvm::Value *> &args);
+    llvm::StructType *get_runtime_vec_type();
+    llvm::StructType *get_runtime_arena_type();
+    // bumps the arena's cursor inline, calling aloha_arena_alloc when full
+    llvm::Value *create_arena_alloc(llvm::Value *arena, uint64_t size);
+    llvm::Value *load_string_length(llvm::Value *str);
+    // ==, inline up to a memcmp of equally long strings
+    llvm::Value *create_string_equality(llvm::Value *left, llvm::Value *right);
+    // !prof weights for a branch whose true edge goes as hinted; null without a hint
+    llvm::MDNode *branch_weights(air::BranchHint hint);
     void generate_main_wrapper();
 
     void generate_function_bodies();
@@ -80,6 +120,24 @@ namespace aloha
                                                 const std::string &var_name,
                                                 llvm::Type *type);
 
+    llvm::Constant *create_string_constant(const std::string &value);
+
+    // one non-wildcard match arm; which pattern field is used follows the
+    // scrutinee type: the enum tag, an integer range or a string
+    struct MatchCase
+    {
+      uint32_t variant_value;
+      std::optional<air::IntRange> range;
+      std::optional<std::string> string;
+      llvm::BasicBlock *block;
+    };
+
+    llvm::BasicBlock *create_unreachable_block(const std::string &name);
+    void emit_match_dispatch(llvm::Value *scrutinee, const std::vector<MatchCase> &cases,
+                             llvm::BasicBlock *default_block);
+    void emit_string_dispatch(llvm::Value *scrutinee, const std::vector<MatchCase> &cases,
+                              llvm::BasicBlock *default_block);
+
     // Expressions
     void visit(air::IntegerLiteral *node) override;
     void visit(air::FloatLiteral *node) override;
@@ -109,6 +167,7 @@ namespace aloha
     void visit(air::If *node) override;
     void visit(air::Match *node) override;
     void visit(air::While *node) override;
+    void visit(air::For *node) override;
     void visit(air::ExprStmt *node) override;
 
     // Top-level declarations
@@ -0,0 +1,320 @@
+#include "codegen.h"
+#include <llvm/IR/Constants.h>
+#include <llvm/IR/DerivedTypes.h>
+#include <llvm/IR/Intrinsics.h>
+#include <llvm/IR/MDBuilder.h>
+#include <array>
+#include <string_view>
+
+namespace aloha
+{
+  void CodeGenerator::register_runtime_intrinsic(air::Function *func)
+  {
+    // only the stdlib and the runtime qualify; a program defining a function
+    // of the same name keeps its own body
+    if (!func->m_is_stdlib)
+      return;
+
+    llvm::Function *llvm_func = function_map[func->m_func_id];
+    if (!llvm_func)
+      return;
+
+    struct IntrinsicName
+    {
+      std::string_view name;
+      size_t param_count;
+      RuntimeIntrinsic intrinsic;
+    };
+
+    // both the stdlib wrappers and the runtime functions they forward to are
+    // recognized, so the stdlib's own objects get the fast paths as well
+    static constexpr std::array<IntrinsicName, 22> names = {{
+        {"vec_int_len", 1, RuntimeIntrinsic::VecLen},
+        {"vec_string_len", 1, RuntimeIntrinsic::VecLen},
+        {"aloha_vec_int_len", 1, RuntimeIntrinsic::VecLen},
+        {"aloha_vec_string_len", 1, RuntimeIntrinsic::VecLen},
+        {"vec_int_get", 2, RuntimeIntrinsic::VecGet},
+        {"vec_string_get", 2, RuntimeIntrinsic::VecGet},
+        {"aloha_vec_int_get", 2, RuntimeIntrinsic::VecGet},
+        {"aloha_vec_string_get", 2, RuntimeIntrinsic::VecGet},
+        {"vec_int_set", 3, RuntimeIntrinsic::VecSet},
+        {"vec_string_set", 3, RuntimeIntrinsic::VecSet},
+        {"aloha_vec_int_set", 3, RuntimeIntrinsic::VecSet},
+        {"aloha_vec_string_set", 3, RuntimeIntrinsic::VecSet},
+        {"vec_int_push", 2, RuntimeIntrinsic::VecPush},
+        {"vec_string_push", 2, RuntimeIntrinsic::VecPush},
+        {"aloha_vec_int_push", 2, RuntimeIntrinsic::VecPush},
+        {"aloha_vec_string_push", 2, RuntimeIntrinsic::VecPush},
+        {"string_len", 1, RuntimeIntrinsic::StringLen},
+        {"aloha_sys_strlen", 1, RuntimeIntrinsic::StringLen},
+        {"string_char_at", 2, RuntimeIntrinsic::StringCharAt},
+        {"aloha_string_char_at", 2, RuntimeIntrinsic::StringCharAt},
+        {"likely", 1, RuntimeIntrinsic::ExpectTrue},
+        {"unlikely", 1, RuntimeIntrinsic::ExpectFalse},
+    }};
+
+    for (const auto &name : names)
+    {
+      if (name.name != func->m_name || name.param_count != func->m_params.size())
+        continue;
+
+      if (name.intrinsic == RuntimeIntrinsic::ExpectTrue || name.intrinsic == RuntimeIntrinsic::ExpectFalse)
+      {
+        if (llvm_func->getFunctionType()->getParamType(0)->isIntegerTy(1))
+          runtime_intrinsics[func->m_func_id] = name.intrinsic;
+        return;
+      }
+
+      // every parameter is a handle, a string or an int: all pointer or i64
+      for (llvm::Type *param : llvm_func->getFunctionType()->params())
+      {
+        if (!param->isPointerTy() && !param->isIntegerTy(64))
+          return;
+      }
+      if (!llvm_func->getFunctionType()->getParamType(0)->isPointerTy())
+        return;
+
+      runtime_intrinsics[func->m_func_id] = name.intrinsic;
+      return;
+    }
+  }
+
+  llvm::StructType *CodeGenerator::get_runtime_vec_type()
+  {
+    // mirrors aloha_vec in stdlib/runtime/vector.c
+    if (auto existing = llvm::StructType::getTypeByName(*context, "aloha.vec"))
+      return existing;
+
+    llvm::Type *ptr_ty = llvm::PointerType::get(*context, 0);
+    llvm::Type *i64_ty = llvm::Type::getInt64Ty(*context);
+    return llvm::StructType::create(*context, {ptr_ty, i64_ty, i64_ty, i64_ty, ptr_ty}, "aloha.vec");
+  }
+
+  llvm::StructType *CodeGenerator::get_runtime_arena_type()
+  {
+    // the leading fields of aloha_arena in stdlib/runtime/runtime.h
+    if (auto existing = llvm::StructType::getTypeByName(*context, "aloha.arena"))
+      return existing;
+
+    llvm::Type *ptr_ty = llvm::PointerType::get(*context, 0);
+    return llvm::StructType::create(*context, {ptr_ty, ptr_ty}, "aloha.arena");
+  }
+
+  llvm::Value *CodeGenerator::create_arena_alloc(llvm::Value *arena, uint64_t size)
+  {
+    llvm::Type *i64_ty = llvm::Type::getInt64Ty(*context);
+    llvm::Type *ptr_ty = llvm::PointerType::get(*context, 0);
+    llvm::StructType *arena_ty = get_runtime_arena_type();
+    llvm::MDNode *likely = branch_weights(air::BranchHint::Likely);
+    // same rounding as aloha_arena_bump
+    uint64_t rounded = (size + 7) & ~uint64_t{7};
+
+    llvm::BasicBlock *check_block = llvm::BasicBlock::Create(*context, "arena.check", current_function);
+    llvm::BasicBlock *bump_block = llvm::BasicBlock::Create(*context, "arena.bump", current_function);
+    llvm::BasicBlock *slow_block = llvm::BasicBlock::Create(*context, "arena.slow", current_function);
+    llvm::BasicBlock *done_block = llvm::BasicBlock::Create(*context, "arena.done", current_function);
+
+    builder->CreateCondBr(builder->CreateIsNotNull(arena, "arena.nonnull"), check_block, slow_block, likely);
+
+    builder->SetInsertPoint(check_block);
+    llvm::Value *cursor_ptr = builder->CreateStructGEP(arena_ty, arena, 0);
+    llvm::Value *cursor = builder->CreateLoad(ptr_ty, cursor_ptr, "arena.cursor");
+    llvm::Value *limit = builder->CreateLoad(ptr_ty, builder->CreateStructGEP(arena_ty, arena, 1), "arena.limit");
+    llvm::Value *room = builder->CreateSub(builder->CreatePtrToInt(limit, i64_ty), builder->CreatePtrToInt(cursor, i64_ty),
+                                           "arena.room");
+    builder->CreateCondBr(builder->CreateICmpUGE(room, llvm::ConstantInt::get(i64_ty, rounded), "arena.fits"),
+                          bump_block, slow_block, likely);
+
+    builder->SetInsertPoint(bump_block);
+    builder->CreateStore(builder->CreateInBoundsGEP(builder->getInt8Ty(), cursor, llvm::ConstantInt::get(i64_ty, rounded),
+                                                    "arena.next"),
+                         cursor_ptr);
+    builder->CreateBr(done_block);
+
+    // opening a new block stays in the runtime
+    builder->SetInsertPoint(slow_block);
+    llvm::FunctionCallee alloc_func = module->getOrInsertFunction(
+        "aloha_arena_alloc", llvm::FunctionType::get(ptr_ty, {ptr_ty, i64_ty}, false));
+    llvm::CallInst *slow_call = builder->CreateCall(alloc_func, {arena, llvm::ConstantInt::get(i64_ty, size)},
+                                                    "arena.call");
+    slow_call->addFnAttr(llvm::Attribute::Cold);
+    builder->CreateBr(done_block);
+
+    builder->SetInsertPoint(done_block);
+    llvm::PHINode *result = builder->CreatePHI(ptr_ty, 2, "newobject");
+    result->addIncoming(cursor, bump_block);
+    result->addIncoming(slow_call, slow_block);
+    return result;
+  }
+
+  llvm::MDNode *CodeGenerator::branch_weights(air::BranchHint hint)
+  {
+    switch (hint)
+    {
+    case air::BranchHint::None:
+      return nullptr;
+    case air::BranchHint::Likely:
+      return llvm::MDBuilder(*context).createBranchWeights(LIKELY_WEIGHT, UNLIKELY_WEIGHT);
+    case air::BranchHint::Unlikely:
+      return llvm::MDBuilder(*context).createBranchWeights(UNLIKELY_WEIGHT, LIKELY_WEIGHT);
+    }
+    return nullptr;
+  }
+
+  llvm::Value *CodeGenerator::load_string_length(llvm::Value *str)
+  {
+    // the length is stored right before the bytes, see create_string_constant;
+    // lines a reader splits in place leave it unaligned
+    llvm::Type *i64_ty = llvm::Type::getInt64Ty(*context);
+    llvm::Value *len_ptr = builder->CreateInBoundsGEP(builder->getInt8Ty(), str,
+                                                   llvm::ConstantInt::getSigned(i64_ty, -8), "str.lenptr");
+    return builder->CreateAlignedLoad(i64_ty, len_ptr, llvm::Align(1), "str.len");
+  }
+
+  llvm::Value *CodeGenerator::create_string_equality(llvm::Value *left, llvm::Value *right)
+  {
+    // Comparing with a literal makes the length a constant, so LLVM can
+    // expand the memcmp into a few loads. Null strings, like input() at the
+    // end of the input, are only equal to each other.
+    llvm::Type *i64_ty = llvm::Type::getInt64Ty(*context);
+    llvm::Type *ptr_ty = llvm::PointerType::get(*context, 0);
+    llvm::BasicBlock *nonnull_block = llvm::BasicBlock::Create(*context, "streq.nonnull", current_function);
+    llvm::BasicBlock *length_block = llvm::BasicBlock::Create(*context, "streq.length", current_function);
+    llvm::BasicBlock *bytes_block = llvm::BasicBlock::Create(*context, "streq.bytes", current_function);
+    llvm::BasicBlock *done_block = llvm::BasicBlock::Create(*context, "streq.done", current_function);
+
+    llvm::BasicBlock *entry_block = builder->GetInsertBlock();
+    builder->CreateCondBr(builder->CreateICmpEQ(left, right, "streq.same"), done_block, nonnull_block);
+
+    builder->SetInsertPoint(nonnull_block);
+    llvm::Value *nonnull = builder->CreateAnd(builder->CreateIsNotNull(left), builder->CreateIsNotNull(right),
+                                              "streq.nonnull");
+    builder->CreateCondBr(nonnull, length_block, done_block);
+
+    builder->SetInsertPoint(length_block);
+    llvm::Value *len = load_string_length(left);
+    builder->CreateCondBr(builder->CreateICmpEQ(len, load_string_length(right), "streq.samelen"),
+                          bytes_block, done_block);
+
+    builder->SetInsertPoint(bytes_block);
+    llvm::FunctionCallee memcmp_func = module->getOrInsertFunction(
+        "memcmp", llvm::FunctionType::get(builder->getInt32Ty(), {ptr_ty, ptr_ty, i64_ty}, false));
+    llvm::Value *cmp = builder->CreateCall(memcmp_func, {left, right, len}, "streq.cmp");
+    llvm::Value *same_bytes = builder->CreateICmpEQ(cmp, builder->getInt32(0), "streq.samebytes");
+    builder->CreateBr(done_block);
+
+    builder->SetInsertPoint(done_block);
+    llvm::PHINode *result = builder->CreatePHI(builder->getInt1Ty(), 4, "streqtmp");
+    result->addIncoming(builder->getTrue(), entry_block);
+    result->addIncoming(builder->getFalse(), nonnull_block);
+    result->addIncoming(builder->getFalse(), length_block);
+    result->addIncoming(same_bytes, bytes_block);
+    return result;
+  }
+
+  llvm::Value *CodeGenerator::emit_runtime_intrinsic(RuntimeIntrinsic intrinsic, llvm::Function *callee,
+                                                     const std::vector<llvm::Value *> &args)
+  {
+    // LowerExpectIntrinsic turns these into weights on the branches using them
+    if (intrinsic == RuntimeIntrinsic::ExpectTrue || intrinsic == RuntimeIntrinsic::ExpectFalse)
+    {
+      llvm::Value *expected = builder->getInt1(intrinsic == RuntimeIntrinsic::ExpectTrue);
+      return builder->CreateIntrinsic(llvm::Intrinsic::expect, {args[0]->getType()}, {args[0], expected},
+                                      nullptr, "expect");
+    }
+
+    llvm::Type *i64_ty = llvm::Type::getInt64Ty(*context);
+    llvm::Type *ptr_ty = llvm::PointerType::get(*context, 0);
+    llvm::StructType *vec_ty = get_runtime_vec_type();
+    llvm::MDNode *likely = branch_weights(air::BranchHint::Likely);
+
+    llvm::BasicBlock *slow_block = llvm::BasicBlock::Create(*context, "rt.slow");
+    llvm::BasicBlock *done_block = llvm::BasicBlock::Create(*context, "rt.done");
+
+    // branches to the fast path when cond holds, otherwise to the runtime call
+    auto guard = [&](llvm::Value *cond, const char *name)
+    {
+      llvm::BasicBlock *next = llvm::BasicBlock::Create(*context, name, current_function);
+      builder->CreateCondBr(cond, next, slow_block, likely);
+      builder->SetInsertPoint(next);
+    };
+
+    llvm::Value *handle = args[0];
+    guard(builder->CreateIsNotNull(handle, "rt.nonnull"), "rt.check");
+
+    llvm::Value *fast_value = nullptr;
+    switch (intrinsic)
+    {
+    case RuntimeIntrinsic::VecLen:
+    {
+      fast_value = builder->CreateLoad(i64_ty, builder->CreateStructGEP(vec_ty, handle, 1), "vec.len");
+      break;
+    }
+    case RuntimeIntrinsic::VecGet:
+    case RuntimeIntrinsic::VecSet:
+    {
+      llvm::Value *len = builder->CreateLoad(i64_ty, builder->CreateStructGEP(vec_ty, handle, 1), "vec.len");
+      // an unsigned compare also sends negative indices to the runtime, which aborts
+      guard(builder->CreateICmpULT(args[1], len, "vec.inbounds"), "vec.fast");
+      llvm::Value *data = builder->CreateLoad(ptr_ty, builder->CreateStructGEP(vec_ty, handle, 0), "vec.data");
+      llvm::Type *elem_ty = intrinsic == RuntimeIntrinsic::VecGet ? callee->getReturnType() : args[2]->getType();
+      llvm::Value *slot = builder->CreateInBoundsGEP(elem_ty, data, args[1], "vec.slot");
+      if (intrinsic == RuntimeIntrinsic::VecGet)
+        fast_value = builder->CreateLoad(elem_ty, slot, "vec.elem");
+      else
+        builder->CreateStore(args[2], slot);
+      break;
+    }
+    case RuntimeIntrinsic::VecPush:
+    {
+      llvm::Value *len_ptr = builder->CreateStructGEP(vec_ty, handle, 1);
+      llvm::Value *len = builder->CreateLoad(i64_ty, len_ptr, "vec.len");
+      llvm::Value *cap = builder->CreateLoad(i64_ty, builder->CreateStructGEP(vec_ty, handle, 2), "vec.cap");
+      // growing the buffer stays in the runtime
+      guard(builder->CreateICmpSLT(len, cap, "vec.hasroom"), "vec.fast");
+      llvm::Value *data = builder->CreateLoad(ptr_ty, builder->CreateStructGEP(vec_ty, handle, 0), "vec.data");
+      builder->CreateStore(args[1], builder->CreateInBoundsGEP(args[1]->getType(), data, len, "vec.slot"));
+      builder->CreateStore(builder->CreateNSWAdd(len, llvm::ConstantInt::get(i64_ty, 1)), len_ptr);
+      break;
+    }
+    case RuntimeIntrinsic::StringLen:
+    case RuntimeIntrinsic::StringCharAt:
+    {
+      llvm::Value *len = load_string_length(handle);
+      if (intrinsic == RuntimeIntrinsic::StringLen)
+      {
+        fast_value = len;
+        break;
+      }
+      guard(builder->CreateICmpULT(args[1], len, "str.inbounds"), "str.fast");
+      llvm::Value *byte_ptr = builder->CreateInBoundsGEP(builder->getInt8Ty(), handle, args[1], "str.byteptr");
+      fast_value = builder->CreateZExt(builder->CreateLoad(builder->getInt8Ty(), byte_ptr, "str.byte"),
+                                       i64_ty, "str.char");
+      break;
+    }
+    case RuntimeIntrinsic::ExpectTrue:
+    case RuntimeIntrinsic::ExpectFalse:
+      break; // handled above, without a slow path
+    }
+    llvm::BasicBlock *fast_end = builder->GetInsertBlock();
+    builder->CreateBr(done_block);
+
+    slow_block->insertInto(current_function);
+    builder->SetInsertPoint(slow_block);
+    llvm::CallInst *slow_call = builder->CreateCall(callee, args);
+    slow_call->addFnAttr(llvm::Attribute::Cold);
+    builder->CreateBr(done_block);
+
+    done_block->insertInto(current_function);
+    builder->SetInsertPoint(done_block);
+    if (!fast_value)
+      return slow_call;
+
+    slow_call->setName("rt.call");
+    llvm::PHINode *result = builder->CreatePHI(fast_value->getType(), 2, "rt.result");
+    result->addIncoming(fast_value, fast_end);
+    result->addIncoming(slow_call, slow_block);
+    return result;
+  }
+
+} // namespace aloha
@@ -1,43 +1,88 @@
 #include "objgen.h"
+#include <llvm/Bitcode/BitcodeWriter.h>
 #include <llvm/IR/LegacyPassManager.h>
 #include <llvm/IR/Verifier.h>
+#include <llvm/IRReader/IRReader.h>
+#include <llvm/Linker/Linker.h>
 #include <llvm/MC/TargetRegistry.h>
+#include <llvm/Passes/PassBuilder.h>
 #include <llvm/Support/CodeGen.h>
 #include <llvm/Support/FileSystem.h>
+#include <llvm/Support/SourceMgr.h>
 #include <llvm/Support/TargetSelect.h>
 #include <llvm/Support/raw_ostream.h>
 #include <llvm/Target/TargetMachine.h>
 #include <llvm/Target/TargetOptions.h>
 #include <llvm/TargetParser/Host.h>
-#include <llvm/Transforms/InstCombine/InstCombine.h>
-#include <llvm/Transforms/Scalar.h>
-#include <llvm/Transforms/Scalar/GVN.h>
-#include <llvm/Transforms/Utils.h>
 #include <system_error>
 
 using namespace llvm;
 
-void optimize_module(llvm::Module *module)
+void emit_bitcode_file(llvm::Module *module, const std::string &output_path)
 {
-  legacy::PassManager pass_manager;
-
-  // Memory to register promotion (critical for removing alloca/load/store)
-  pass_manager.add(createPromoteMemoryToRegisterPass());
-
-  // Instruction combining and simplification
-  pass_manager.add(createInstructionCombiningPass());
-
-  // Control flow simplification
-  pass_manager.add(createCFGSimplificationPass());
+  std::error_code EC;
+  raw_fd_ostream dest(output_path, EC, sys::fs::OF_None);
+  if (EC)
+  {
+    throw std::runtime_error("Could not open file: " + EC.message());
+  }
 
-  // Dead code elimination
-  pass_manager.add(createDeadCodeEliminationPass());
+  WriteBitcodeToFile(*module, dest);
+  dest.flush();
+}
 
-  // Global Value Numbering (common subexpression elimination)
-  pass_manager.add(createGVNPass());
+void link_available_externally(llvm::Module *module, const std::vector<std::string> &bitcode_files)
+{
+  for (const auto &path : bitcode_files)
+  {
+    // without the bitcode the module's functions are merely not inlined
+    SMDiagnostic error;
+    std::unique_ptr<Module> imported = getLazyIRFileModule(path, error, module->getContext());
+    if (!imported)
+    {
+      continue;
+    }
+
+    // the definitions are only there to be inlined; the module's object is
+    // linked as before and keeps the one emitted copy of each symbol
+    imported->setTargetTriple(module->getTargetTriple());
+    imported->setDataLayout(module->getDataLayout());
+    for (GlobalObject &object : imported->global_objects())
+    {
+      if (!object.isDeclaration() && object.hasExternalLinkage())
+      {
+        object.setLinkage(GlobalValue::AvailableExternallyLinkage);
+      }
+    }
+
+    if (Linker::linkModules(*module, std::move(imported), Linker::Flags::LinkOnlyNeeded))
+    {
+      throw std::runtime_error("Could not link bitcode file: " + path);
+    }
+  }
+}
 
-  // Run the passes
-  pass_manager.run(*module);
+void optimize_module(llvm::Module *module)
+{
+  LoopAnalysisManager loop_analyses;
+  FunctionAnalysisManager function_analyses;
+  CGSCCAnalysisManager cgscc_analyses;
+  ModuleAnalysisManager module_analyses;
+
+  PassBuilder pass_builder;
+  pass_builder.registerModuleAnalyses(module_analyses);
+  pass_builder.registerCGSCCAnalyses(cgscc_analyses);
+  pass_builder.registerFunctionAnalyses(function_analyses);
+  pass_builder.registerLoopAnalyses(loop_analyses);
+  pass_builder.crossRegisterProxies(loop_analyses, function_analyses, cgscc_analyses,
+                                    module_analyses);
+
+  // The standard O2 pipeline: besides mem2reg, instcombine and GVN it runs
+  // the loop rotation, unrolling and vectorization passes that counted for
+  // loops are shaped for
+  ModulePassManager pass_manager =
+      pass_builder.buildPerModuleDefaultPipeline(OptimizationLevel::O2);
+  pass_manager.run(*module, module_analyses);
 
   // Verify the module after optimization
   verifyModule(*module);
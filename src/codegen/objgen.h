@@ -3,6 +3,7 @@
 
 #include <llvm/IR/Module.h>
 #include <string>
+#include <vector>
 
 namespace llvm
 {
@@ -12,6 +13,13 @@ namespace llvm
 // Emit object file from LLVM module
 void emit_object_file(llvm::Module *module, const std::string &output_path);
 
+// Emit LLVM bitcode from module, so that importers can inline its functions
+void emit_bitcode_file(llvm::Module *module, const std::string &output_path);
+
+// Bring in the function bodies from bitcode files as available_externally,
+// for the optimizer to inline; the objects still provide the symbols
+void link_available_externally(llvm::Module *module, const std::vector<std::string> &bitcode_files);
+
 // Apply optimization passes to module
 void optimize_module(llvm::Module *module);
 
@@ -1,6 +1,8 @@
 #include "driver.h"
+#include "../air/pass_manager.h"
 #include "../air/printer.h"
 #include "../codegen/objgen.h"
+#include "../modules/interface.h"
 #include "../utils/paths.h"
 #include <cstdlib>
 #include <iostream>
@@ -38,6 +40,26 @@ namespace aloha
     diagnostics.print_all();
   }
 
+  std::vector<std::string> CompilerDriver::get_source_files() const
+  {
+    std::vector<std::string> files = {options.input_file};
+    if (import_resolver)
+    {
+      const auto &import_paths = import_resolver->get_import_paths();
+      files.insert(files.end(), import_paths.begin(), import_paths.end());
+    }
+    return files;
+  }
+
+  std::vector<std::string> CompilerDriver::get_compiled_imports() const
+  {
+    if (!import_resolver)
+    {
+      return {};
+    }
+    return import_resolver->get_compiled_import_paths();
+  }
+
   void CompilerDriver::log(const std::string &message) const
   {
     if (options.verbose)
@@ -199,8 +221,6 @@ namespace aloha
 
     try
     {
-      symbol_binder = std::make_unique<aloha::SymbolBinder>(*ty_table, diagnostics);
-
       if (!symbol_binder->bind(ast.get(), type_arena) || diagnostics.has_errors())
       {
         return fail_stage_or_diagnostics(DiagnosticPhase::SymbolBinding,
@@ -224,8 +244,14 @@ namespace aloha
 
     try
     {
+      // imports are bound first so the entry file's signatures can name imported types
+      symbol_binder = std::make_unique<aloha::SymbolBinder>(*ty_table, diagnostics);
       import_resolver = std::make_unique<aloha::ImportResolver>(
           *ty_table, symbol_binder->get_symbol_table(), type_arena, diagnostics, options.input_file);
+      if (!options.module_cache_dir.empty())
+      {
+        import_resolver->set_module_cache_dir(options.module_cache_dir);
+      }
 
       if (!import_resolver->resolve_imports(ast.get()) || diagnostics.has_errors())
       {
@@ -332,6 +358,7 @@ namespace aloha
 
           for (auto &func : imported_module->m_functions)
           {
+            func->m_is_imported = true;
             air_module->m_functions.push_back(std::move(func));
           }
           for (auto &struct_decl : imported_module->m_structs)
@@ -339,9 +366,30 @@ namespace aloha
             air_module->m_structs.push_back(std::move(struct_decl));
           }
         }
+
+        // passes and codegen give the stdlib's own functions special
+        // treatment whether its modules came precompiled or as source
+        for (auto &func : air_module->m_functions)
+        {
+          func->m_is_stdlib = func->m_loc.file_path &&
+                              import_resolver->is_stdlib_module(*func->m_loc.file_path);
+        }
       }
 
       log("AIR building completed successfully");
+
+      auto pass_manager = air::PassManager::default_pipeline(options.release);
+      pass_manager.run(*air_module);
+      if (options.verbose)
+      {
+        std::cout << "[INFO] AIR passes:\n";
+        pass_manager.print_report(std::cout);
+      }
+      if (options.print_remarks)
+      {
+        pass_manager.print_remarks(std::cerr);
+      }
+
       dump_air();
       return true;
     }
@@ -390,6 +438,10 @@ namespace aloha
 
     try
     {
+      if (import_resolver)
+      {
+        link_available_externally(llvm_module.get(), import_resolver->get_interface_bitcode());
+      }
       optimize_module(llvm_module.get());
       log("Optimization passes completed");
       return true;
@@ -464,6 +516,56 @@ namespace aloha
     }
   }
 
+  bool CompilerDriver::stage_emit_interface()
+  {
+    if (!options.emit_interface)
+    {
+      return true;
+    }
+
+    log_stage("Emitting Module Interface");
+
+    try
+    {
+      std::string interface_file = get_output_name(INTERFACE_EXTENSION);
+      std::string source_file = std::filesystem::absolute(options.input_file).lexically_normal().string();
+
+      // the object is recorded relative to the interface so both can be moved together
+      auto interface_dir = std::filesystem::absolute(interface_file).parent_path();
+      std::string obj_file = std::filesystem::absolute(get_output_name(".o"))
+                                 .lexically_normal()
+                                 .lexically_relative(interface_dir)
+                                 .string();
+
+      // so are the imports the object was compiled against, so that a tree
+      // of modules can move as a whole; stdlib sources come with the compiler
+      std::vector<InterfaceDependency> dependencies;
+      for (const auto &import_path : import_resolver->get_import_paths())
+      {
+        if (!import_resolver->is_stdlib_module(import_path))
+        {
+          std::string relative = std::filesystem::path(import_path)
+                                     .lexically_normal()
+                                     .lexically_relative(interface_dir)
+                                     .string();
+          dependencies.push_back({relative, hash_source_file(import_path)});
+        }
+      }
+
+      write_module_interface(interface_file, *ast, type_arena, source_file, obj_file, dependencies);
+      emit_bitcode_file(llvm_module.get(), get_output_name(BITCODE_EXTENSION));
+
+      std::cout << "Module interface written to: " << interface_file << std::endl;
+      return true;
+    }
+    catch (const std::exception &e)
+    {
+      return fail_with_diagnostic(DiagnosticPhase::Emission,
+                                  "Interface emission exception: " + std::string(e.what()),
+                                  false);
+    }
+  }
+
   bool CompilerDriver::stage_link_executable()
   {
     if (!options.emit_executable)
@@ -508,13 +610,15 @@ namespace aloha
 
       log("Using C compiler for linking: " + link_driver);
 
-      std::vector<llvm::StringRef> args = {
-          link_driver,
-          obj_file,
-          stdlib_path,
-          "-no-pie",
-          "-o",
-          exe_file};
+      std::vector<llvm::StringRef> args = {link_driver, obj_file};
+      if (import_resolver)
+      {
+        for (const auto &interface_obj : import_resolver->get_interface_objects())
+        {
+          args.push_back(interface_obj);
+        }
+      }
+      args.insert(args.end(), {stdlib_path, "-no-pie", "-o", exe_file});
 
       std::string error_msg;
       int result = llvm::sys::ExecuteAndWait(link_driver, args, std::nullopt, {}, 0, 0,
@@ -554,10 +658,10 @@ namespace aloha
     if (!stage_parse())
       return 1;
 
-    if (!stage_symbol_binding())
+    if (!stage_import_resolution())
       return 1;
 
-    if (!stage_import_resolution())
+    if (!stage_symbol_binding())
       return 1;
 
     if (!stage_type_resolution())
@@ -578,9 +682,17 @@ namespace aloha
     if (!stage_emit_object())
       return 1;
 
+    if (!stage_emit_interface())
+      return 1;
+
     if (!stage_link_executable())
       return 1;
 
+    // warnings, e.g. an interface ignored in favour of its source, are
+    // otherwise only printed along with an error
+    if (diagnostics.warning_count() > 0)
+      diagnostics.print_all();
+
     std::cout << "\n========================================\n";
     std::cout << "Compilation successful!\n";
     std::cout << "========================================\n";
@@ -13,6 +13,7 @@
 #include "../codegen/codegen.h"
 #include <memory>
 #include <string>
+#include <vector>
 #include <llvm/IR/Module.h>
 
 namespace aloha
@@ -26,9 +27,14 @@ namespace aloha
     bool dump_ir = false;
     bool emit_llvm = false;
     bool emit_object = true;
+    bool emit_interface = false;
     bool emit_executable = true;
     bool enable_optimization = false;
+    bool release = false; // compile out assert and assert_msg
     bool verbose = false;
+    bool print_remarks = false;
+    // where imports may have been compiled ahead, see Watcher
+    std::string module_cache_dir;
   };
 
   class CompilerDriver
@@ -41,6 +47,12 @@ namespace aloha
     bool has_errors() const;
     void print_errors() const;
 
+    // entry file followed by every file pulled in through imports
+    std::vector<std::string> get_source_files() const;
+
+    // imports compiled from source in this run, dependencies first
+    std::vector<std::string> get_compiled_imports() const;
+
   private:
     CompilerOptions options;
 
@@ -71,6 +83,7 @@ namespace aloha
     bool stage_optimize();
     bool stage_emit_llvm_ir();
     bool stage_emit_object();
+    bool stage_emit_interface();
     bool stage_link_executable();
 
     std::string get_base_name() const;
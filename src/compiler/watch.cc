@@ -0,0 +1,364 @@
+#include "watch.h"
+#include "../modules/interface.h"
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <unordered_set>
+
+#if defined(__linux__)
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#else
+#error "Unsupported platform. Currently only Linux is supported."
+#endif
+
+namespace aloha
+{
+  namespace
+  {
+    constexpr int DEBOUNCE_MS = 100;
+    constexpr const char *MODULE_CACHE_DIR = ".aloha-watch";
+
+    std::string normalize(const std::string &path)
+    {
+      std::error_code ec;
+      auto canonical = std::filesystem::weakly_canonical(path, ec);
+      if (ec)
+      {
+        return std::filesystem::absolute(path).lexically_normal().string();
+      }
+      return canonical.string();
+    }
+
+    void remove_module_files(const std::string &base)
+    {
+      std::error_code ec;
+      for (const char *extension : {INTERFACE_EXTENSION, ".o", BITCODE_EXTENSION})
+      {
+        std::filesystem::remove(base + extension, ec);
+      }
+    }
+
+    // keeps the output of the builds behind the module cache off the terminal
+    class SilencedOutput
+    {
+    public:
+      SilencedOutput()
+          : cout_buf(std::cout.rdbuf(discarded.rdbuf())),
+            cerr_buf(std::cerr.rdbuf(discarded.rdbuf())) {}
+      ~SilencedOutput()
+      {
+        std::cout.rdbuf(cout_buf);
+        std::cerr.rdbuf(cerr_buf);
+      }
+
+    private:
+      std::ostringstream discarded;
+      std::streambuf *cout_buf;
+      std::streambuf *cerr_buf;
+    };
+  } // namespace
+
+  Watcher::Watcher(const CompilerOptions &options) : options(options), inotify_fd(-1) {}
+
+  Watcher::~Watcher()
+  {
+    if (inotify_fd >= 0)
+    {
+      close(inotify_fd);
+    }
+  }
+
+  std::size_t Watcher::hash_file(const std::string &path)
+  {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+      return 0;
+    }
+    std::string content((std::istreambuf_iterator<char>(file)),
+                        std::istreambuf_iterator<char>());
+    return std::hash<std::string>{}(content);
+  }
+
+  void Watcher::compile_once()
+  {
+    CompilerDriver driver(options);
+    bool built = driver.compile() == 0;
+
+    watched_files.clear();
+    for (const auto &path : driver.get_source_files())
+    {
+      watched_files.push_back(normalize(path));
+    }
+
+    // imports the build found for the first time
+    for (const auto &path : watched_files)
+    {
+      if (!source_hashes.count(path))
+      {
+        source_hashes[path] = hash_file(path);
+      }
+    }
+
+    if (built)
+    {
+      cache_modules(driver.get_compiled_imports());
+    }
+  }
+
+  void Watcher::drop_stale_modules()
+  {
+    for (auto it = cached_modules.begin(); it != cached_modules.end();)
+    {
+      bool stale = false;
+      for (const auto &[path, hash] : it->second.inputs)
+      {
+        // a failed build watches fewer files; hash the rest here
+        auto current = source_hashes.find(path);
+        if (current == source_hashes.end())
+        {
+          current = source_hashes.emplace(path, hash_file(path)).first;
+        }
+        if (current->second != hash)
+        {
+          stale = true;
+          break;
+        }
+      }
+
+      if (stale)
+      {
+        remove_module_files(it->second.base);
+        it = cached_modules.erase(it);
+      }
+      else
+      {
+        ++it;
+      }
+    }
+  }
+
+  void Watcher::cache_modules(const std::vector<std::string> &imports)
+  {
+    if (options.module_cache_dir.empty())
+    {
+      return;
+    }
+
+    // dependencies come first, so each module finds its imports cached
+    for (const auto &import : imports)
+    {
+      std::string path = normalize(import);
+      if (!cached_modules.count(path) && !cache_module(path) && options.verbose)
+      {
+        std::cout << "[INFO] Not caching " << path << ", it is rebuilt from source" << std::endl;
+      }
+    }
+  }
+
+  bool Watcher::cache_module(const std::string &path)
+  {
+    CompilerOptions module_options;
+    module_options.input_file = path;
+    module_options.output_file = (cache_dir / module_cache_stem(path)).string();
+    module_options.emit_interface = true;
+    module_options.emit_executable = false;
+    module_options.enable_optimization = options.enable_optimization;
+    module_options.release = options.release;
+    module_options.module_cache_dir = options.module_cache_dir;
+
+    CompilerDriver driver(module_options);
+    int result;
+    {
+      SilencedOutput silenced;
+      result = driver.compile();
+    }
+
+    // an import of the module that is not cached would end up in the
+    // module's object as well as in the program's, and be linked twice
+    if (result != 0 || !driver.get_compiled_imports().empty())
+    {
+      remove_module_files(module_options.output_file);
+      return false;
+    }
+
+    CachedModule module{module_options.output_file, {}};
+    for (const auto &file : driver.get_source_files())
+    {
+      std::string input = normalize(file);
+      auto hash = source_hashes.find(input);
+      module.inputs[input] = hash != source_hashes.end() ? hash->second : hash_file(input);
+    }
+    cached_modules[path] = std::move(module);
+
+    if (options.verbose)
+    {
+      std::cout << "[INFO] Cached " << path << std::endl;
+    }
+    return true;
+  }
+
+  void Watcher::record_hashes()
+  {
+    source_hashes.clear();
+    for (const auto &path : watched_files)
+    {
+      source_hashes[path] = hash_file(path);
+    }
+  }
+
+  bool Watcher::sources_changed()
+  {
+    for (const auto &path : watched_files)
+    {
+      auto it = source_hashes.find(path);
+      if (it == source_hashes.end() || it->second != hash_file(path))
+      {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void Watcher::watch_directories()
+  {
+    for (const auto &path : watched_files)
+    {
+      std::string dir = std::filesystem::path(path).parent_path().string();
+      if (watched_dirs.count(dir))
+      {
+        continue;
+      }
+
+      int wd = inotify_add_watch(inotify_fd, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE);
+      if (wd < 0)
+      {
+        std::cerr << "ERROR: cannot watch " << dir << ": " << std::strerror(errno) << std::endl;
+        continue;
+      }
+      watch_dirs[wd] = dir;
+      watched_dirs.insert(dir);
+    }
+  }
+
+  bool Watcher::wait_for_change()
+  {
+    if (watch_dirs.empty())
+    {
+      return false;
+    }
+
+    std::unordered_set<std::string> files(watched_files.begin(), watched_files.end());
+
+    std::array<char, 4096> buffer{};
+    bool changed = false;
+    while (!changed)
+    {
+      ssize_t len = read(inotify_fd, buffer.data(), buffer.size());
+      if (len < 0)
+      {
+        if (errno == EINTR)
+          continue;
+        std::cerr << "ERROR: inotify read failed: " << std::strerror(errno) << std::endl;
+        return false;
+      }
+
+      for (ssize_t offset = 0; offset < len;)
+      {
+        auto *event = reinterpret_cast<inotify_event *>(buffer.data() + offset);
+        auto dir = watch_dirs.find(event->wd);
+        if (event->len > 0 && dir != watch_dirs.end())
+        {
+          auto path = std::filesystem::path(dir->second) / event->name;
+          if (files.count(path.lexically_normal().string()))
+          {
+            changed = true;
+          }
+        }
+        offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+      }
+    }
+
+    // editors tend to emit several events per save; drain them before rebuilding
+    pollfd pfd{inotify_fd, POLLIN, 0};
+    while (poll(&pfd, 1, DEBOUNCE_MS) > 0)
+    {
+      if (read(inotify_fd, buffer.data(), buffer.size()) <= 0)
+        break;
+    }
+
+    return true;
+  }
+
+  void Watcher::rebuild()
+  {
+    // hashed before compiling: a save that lands while the build runs then
+    // differs from what was recorded and triggers another build
+    record_hashes();
+    drop_stale_modules();
+    compile_once();
+    watch_directories();
+  }
+
+  int Watcher::run()
+  {
+    inotify_fd = inotify_init1(IN_CLOEXEC);
+    if (inotify_fd < 0)
+    {
+      std::cerr << "ERROR: inotify_init1 failed: " << std::strerror(errno) << std::endl;
+      return 1;
+    }
+
+    // entries left by an earlier session have no hashes to check them by
+    std::filesystem::path output_dir = options.output_file.empty()
+                                           ? std::filesystem::current_path()
+                                           : std::filesystem::absolute(options.output_file).parent_path();
+    cache_dir = output_dir / MODULE_CACHE_DIR;
+    std::error_code ec;
+    std::filesystem::remove_all(cache_dir, ec);
+    std::filesystem::create_directories(cache_dir, ec);
+    if (ec)
+    {
+      std::cerr << "WARNING: cannot create " << cache_dir.string() << ": " << ec.message()
+                << ", imports are rebuilt from source" << std::endl;
+    }
+    else
+    {
+      options.module_cache_dir = cache_dir.string();
+    }
+
+    watched_files = {normalize(options.input_file)};
+    rebuild();
+
+    while (true)
+    {
+      std::cout << "\nWatching " << watched_files.size() << " file(s) for changes..."
+                << std::endl;
+
+      if (!wait_for_change())
+      {
+        return 1;
+      }
+
+      if (!sources_changed())
+      {
+        if (options.verbose)
+        {
+          std::cout << "[INFO] Sources unchanged, skipping rebuild" << std::endl;
+        }
+        continue;
+      }
+
+      rebuild();
+    }
+  }
+
+} // namespace aloha
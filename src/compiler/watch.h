@@ -0,0 +1,64 @@
+#ifndef COMPILER_WATCH_H_
+#define COMPILER_WATCH_H_
+
+#include "driver.h"
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace aloha
+{
+  // Re-runs the compiler whenever the entry file or one of its imports changes.
+  // Uses inotify on the directories containing the sources, so editors that
+  // save through a rename are picked up as well. Imports are compiled once
+  // into a module cache next to the output; later builds read their
+  // interfaces instead of parsing, binding and generating them again, until
+  // the import or anything it depends on changes.
+  class Watcher
+  {
+  public:
+    explicit Watcher(const CompilerOptions &options);
+    ~Watcher();
+    int run();
+
+  private:
+    // an import compiled into the module cache
+    struct CachedModule
+    {
+      std::string base; // cache path without extension
+      // content hash of every file the module was compiled from
+      std::unordered_map<std::string, std::size_t> inputs;
+    };
+
+    CompilerOptions options;
+    std::filesystem::path cache_dir;
+    std::unordered_map<std::string, CachedModule> cached_modules; // by source path
+
+    // last seen content hash per source file
+    std::unordered_map<std::string, std::size_t> source_hashes;
+    std::vector<std::string> watched_files;
+
+    // kept open for the watcher's lifetime, so that saves made while a build
+    // runs are queued rather than missed
+    int inotify_fd;
+    std::unordered_map<int, std::string> watch_dirs; // by watch descriptor
+    std::unordered_set<std::string> watched_dirs;
+
+    void rebuild();
+    void compile_once();
+    bool sources_changed();
+    bool wait_for_change();
+    void record_hashes();
+    void watch_directories();
+    void drop_stale_modules();
+    void cache_modules(const std::vector<std::string> &imports);
+    bool cache_module(const std::string &path);
+
+    static std::size_t hash_file(const std::string &path);
+  };
+} // namespace aloha
+
+#endif // COMPILER_WATCH_H_
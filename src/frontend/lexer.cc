@@ -48,6 +48,13 @@ Lexer::Lexer(std::string_view source, std::string file_path)
       has_peeked(false),
       eof_token(TokenKind::EOF_TOKEN, Location(1, 1, source_file)) {}
 
+Lexer::Lexer(std::string_view source, std::string file_path, uint32_t first_line, uint32_t first_col)
+    : Lexer(source, std::move(file_path))
+{
+  current_loc.line = first_line;
+  current_loc.col = first_col;
+}
+
 bool Lexer::is_eof() const { return pos >= source.size(); }
 
 char Lexer::peek_token() const { return peek_token(0); }
@@ -223,6 +230,9 @@ Token Lexer::lex_single_token()
     return peek_token(1) == '=' ? make_two_char_token(TokenKind::NOT_EQUAL, TokenKind::BANG)
                                 : make_single_token(TokenKind::BANG);
 
+  case '@':
+    return make_single_token(TokenKind::AT);
+
   case '&':
     if (peek_token(1) == '&')
     {
@@ -239,6 +249,20 @@ Token Lexer::lex_single_token()
     consume_token();
     return lex_single_token();
 
+  case '.':
+    if (peek_token(1) == '.')
+    {
+      if (peek_token(2) == '=')
+      {
+        consume_token(3);
+        return Token(TokenKind::DOT_DOT_EQUAL, token_loc);
+      }
+      return make_two_char_token(TokenKind::DOT_DOT, TokenKind::DOT_DOT);
+    }
+    add_error("Unexpected character");
+    consume_token();
+    return lex_single_token();
+
   case '<':
     return peek_token(1) == '=' ? make_two_char_token(TokenKind::LESS_EQUAL, TokenKind::LESS_THAN)
                                 : make_single_token(TokenKind::LESS_THAN);
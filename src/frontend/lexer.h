@@ -11,6 +11,8 @@ class Lexer
 {
 public:
   explicit Lexer(std::string_view source, std::string file_path = "<input>");
+  // for a piece of a larger file; locations count from where the piece starts
+  Lexer(std::string_view source, std::string file_path, uint32_t first_line, uint32_t first_col);
 
   bool has_error() const { return has_errors; }
 
@@ -4,6 +4,8 @@
 #include "token.h"
 #include <algorithm>
 #include <array>
+#include <charconv>
+#include <cstdint>
 #include <iostream>
 #include <memory>
 #include <optional>
@@ -15,6 +17,22 @@
 
 namespace aloha
 {
+  namespace
+  {
+    // the value of a decimal INT token, or nullopt when it does not fit
+    std::optional<uint64_t> parse_magnitude(const std::string &digits)
+    {
+      uint64_t value = 0;
+      const char *end = digits.data() + digits.size();
+      auto [parsed_end, ec] = std::from_chars(digits.data(), end, value);
+      if (ec != std::errc() || parsed_end != end)
+      {
+        return std::nullopt;
+      }
+      return value;
+    }
+  } // namespace
+
   Parser::Parser(Lexer &lexer, TySpecArena &arena, DiagnosticEngine &diag)
       : lexer(&lexer),
         current_token(TokenKind::EOF_TOKEN, Location()),
@@ -154,6 +172,9 @@ namespace aloha
 
   ast::NodePtr Parser::parse_top_level_declaration()
   {
+    Location attributes_loc = current_location();
+    auto attributes = parse_function_attributes();
+
     bool is_public = false;
     if (match("pub"))
     {
@@ -161,6 +182,13 @@ namespace aloha
       advance();
     }
 
+    if (!attributes.empty() && !match("fun") && !(match("extern") && match("fun", true)))
+    {
+      report_error("Attributes can only be applied to functions");
+      synchronize();
+      return nullptr;
+    }
+
     if (match("import"))
     {
       if (is_public)
@@ -183,7 +211,10 @@ namespace aloha
     {
       if (match("fun", true))
       {
-        return parse_extern_function(is_public);
+        auto func = parse_extern_function(is_public);
+        func->m_attributes = std::move(attributes);
+        check_function_attributes(*func, attributes_loc);
+        return func;
       }
       if (match("type", true))
       {
@@ -196,7 +227,10 @@ namespace aloha
     }
     if (match("fun"))
     {
-      return parse_function(is_public);
+      auto func = parse_function(is_public);
+      func->m_attributes = std::move(attributes);
+      check_function_attributes(*func, attributes_loc);
+      return func;
     }
 
     report_error("Expected top-level declaration");
@@ -204,6 +238,66 @@ namespace aloha
     return nullptr;
   }
 
+  std::vector<ast::FunctionAttribute> Parser::parse_function_attributes()
+  {
+    std::vector<ast::FunctionAttribute> attributes;
+    while (match(TokenKind::AT))
+    {
+      advance();
+      std::string name = match(TokenKind::IDENT) ? peek()->get_lexeme() : "";
+      auto attribute = ast::function_attribute_from_name(name);
+      if (!attribute)
+      {
+        report_error("Unknown function attribute '@" + name + "'");
+      }
+      else if (std::find(attributes.begin(), attributes.end(), *attribute) != attributes.end())
+      {
+        report_error("Duplicate function attribute '@" + name + "'");
+      }
+      else
+      {
+        attributes.push_back(*attribute);
+      }
+
+      if (match(TokenKind::IDENT))
+      {
+        advance();
+      }
+    }
+    return attributes;
+  }
+
+  void Parser::check_function_attributes(const ast::Function &func, const Location &loc)
+  {
+    using ast::FunctionAttribute;
+
+    auto conflict = [&](FunctionAttribute first, FunctionAttribute second)
+    {
+      if (func.has_attribute(first) && func.has_attribute(second))
+      {
+        diagnostics.error(DiagnosticPhase::Parser, loc,
+                          std::string("'@") + ast::function_attribute_name(first) + "' and '@" +
+                              ast::function_attribute_name(second) + "' cannot be combined");
+      }
+    };
+    conflict(FunctionAttribute::Inline, FunctionAttribute::NoInline);
+    conflict(FunctionAttribute::Hot, FunctionAttribute::Cold);
+
+    // inlining decisions need a body to act on
+    if (func.m_is_extern)
+    {
+      for (FunctionAttribute attribute : {FunctionAttribute::Inline, FunctionAttribute::NoInline})
+      {
+        if (func.has_attribute(attribute))
+        {
+          diagnostics.error(DiagnosticPhase::Parser, loc,
+                            std::string("'@") + ast::function_attribute_name(attribute) +
+                                "' cannot be applied to extern function '" + func.m_name->m_name + "'");
+        }
+      }
+    }
+  }
+
   Parser::FunctionSignature Parser::parse_function_signature()
   {
     auto identifier = expect_identifier();
@@ -423,6 +517,11 @@ namespace aloha
       {
         arms.emplace_back(pattern->m_loc, parse_expression(0));
       }
+      else if (pattern->m_literal.has_value())
+      {
+        arms.emplace_back(pattern->m_loc, std::move(pattern->m_literal.value()),
+                          parse_expression(0));
+      }
       else
       {
         arms.emplace_back(pattern->m_loc, std::move(pattern->m_path.value()),
@@ -455,7 +554,40 @@ namespace aloha
     if (match(TokenKind::UNDERSCORE))
     {
       advance();
-      return ast::MatchPattern{loc, true, std::nullopt};
+      return ast::MatchPattern{loc, true, std::nullopt, std::nullopt};
+    }
+
+    if (match(TokenKind::STRING))
+    {
+      ast::LiteralPattern literal{ast::LiteralPattern::Kind::String, 0, 0, false,
+                                  peek()->get_lexeme()};
+      advance();
+      return ast::MatchPattern{loc, false, std::nullopt, std::move(literal)};
+    }
+
+    if (match(TokenKind::INT) || match(TokenKind::MINUS))
+    {
+      auto low = parse_match_integer();
+      if (!low.has_value())
+      {
+        return std::nullopt;
+      }
+
+      ast::LiteralPattern literal{ast::LiteralPattern::Kind::Integer, *low, *low, false, ""};
+      if (match(TokenKind::DOT_DOT) || match(TokenKind::DOT_DOT_EQUAL))
+      {
+        literal.m_kind = ast::LiteralPattern::Kind::Range;
+        literal.m_inclusive = match(TokenKind::DOT_DOT_EQUAL);
+        advance();
+
+        auto high = parse_match_integer();
+        if (!high.has_value())
+        {
+          return std::nullopt;
+        }
+        literal.m_high = *high;
+      }
+      return ast::MatchPattern{loc, false, std::nullopt, std::move(literal)};
     }
 
     auto path = parse_qualified_path();
@@ -463,7 +595,34 @@ namespace aloha
     {
       return std::nullopt;
     }
-    return ast::MatchPattern{loc, false, std::move(path)};
+    return ast::MatchPattern{loc, false, std::move(path), std::nullopt};
+  }
+
+  std::optional<int64_t> Parser::parse_match_integer()
+  {
+    bool negative = match(TokenKind::MINUS);
+    if (negative)
+    {
+      advance();
+    }
+
+    if (!match(TokenKind::INT))
+    {
+      report_error("Expected integer in match pattern");
+      return std::nullopt;
+    }
+
+    // the magnitude of the most negative int is one more than the largest
+    std::optional<uint64_t> magnitude = parse_magnitude(peek()->get_lexeme());
+    uint64_t limit = static_cast<uint64_t>(INT64_MAX) + (negative ? 1 : 0);
+    if (!magnitude.has_value() || *magnitude > limit)
+    {
+      // the pattern is still well formed, so parsing goes on
+      report_error("Integer in match pattern is out of range");
+      magnitude = 0;
+    }
+    advance();
+    return negative ? static_cast<int64_t>(0 - *magnitude) : static_cast<int64_t>(*magnitude);
   }
 
   std::vector<ast::Parameter> Parser::parse_parameters()
@@ -517,6 +676,10 @@ namespace aloha
     {
       return parse_while_loop();
     }
+    if (match("for"))
+    {
+      return parse_for_loop();
+    }
     if (match(TokenKind::IDENT))
     {
       return parse_identifier_statement();
@@ -594,7 +757,8 @@ namespace aloha
   {
     return dynamic_cast<const ast::IfStatement *>(stmt) == nullptr &&
            dynamic_cast<const ast::MatchStatement *>(stmt) == nullptr &&
-           dynamic_cast<const ast::WhileLoop *>(stmt) == nullptr;
+           dynamic_cast<const ast::WhileLoop *>(stmt) == nullptr &&
+           dynamic_cast<const ast::ForLoop *>(stmt) == nullptr;
   }
 
   void Parser::consume_statement_semicolon()
@@ -615,7 +779,7 @@ namespace aloha
     synchronize();
   }
 
-  std::unique_ptr<ast::Statement> Parser::parse_variable_declaration()
+  std::unique_ptr<ast::Declaration> Parser::parse_variable_declaration()
   {
     Location loc = current_location();
     bool is_mutable = match("mut");
@@ -650,7 +814,7 @@ namespace aloha
         std::move(expression), std::move(is_mutable));
   }
 
-  std::unique_ptr<ast::Statement> Parser::parse_variable_assignment()
+  std::unique_ptr<ast::Assignment> Parser::parse_variable_assignment()
   {
     Location loc = current_location();
     auto identifier = expect_identifier();
@@ -768,6 +932,11 @@ namespace aloha
       {
         arms.emplace_back(pattern->m_loc, parse_statements());
       }
+      else if (pattern->m_literal.has_value())
+      {
+        arms.emplace_back(pattern->m_loc, std::move(pattern->m_literal.value()),
+                          parse_statements());
+      }
       else
       {
         arms.emplace_back(pattern->m_loc, std::move(pattern->m_path.value()),
@@ -798,6 +967,23 @@ namespace aloha
                                             std::move(body));
   }
 
+  std::unique_ptr<ast::Statement> Parser::parse_for_loop()
+  {
+    Location loc = current_location();
+    consume("for", "Expected 'for' keyword");
+    consume(TokenKind::LEFT_PAREN, "Expected '(' after 'for'");
+    auto initializer = parse_variable_declaration();
+    consume(TokenKind::SEMICOLON, "Expected ';' after for loop initializer");
+    auto condition = parse_expression(0);
+    consume(TokenKind::SEMICOLON, "Expected ';' after for loop condition");
+    auto increment = parse_variable_assignment();
+    consume(TokenKind::RIGHT_PAREN, "Expected ')' after for loop increment");
+    consume(TokenKind::LEFT_BRACE, "Expected '{' keyword after for loop header");
+    auto body = parse_statements();
+    return std::make_unique<ast::ForLoop>(loc, std::move(initializer), std::move(condition),
+                                          std::move(increment), std::move(body));
+  }
+
   enum Precedence
   {
     PREC_LOGICAL_OR = 1,
@@ -928,8 +1114,13 @@ namespace aloha
 
     if (match(TokenKind::INT))
     {
+      std::optional<uint64_t> value = parse_magnitude(token->get_lexeme());
+      if (!value.has_value() || *value > static_cast<uint64_t>(INT64_MAX))
+      {
+        report_error("Integer literal is out of range");
+      }
       advance();
-      return std::make_unique<ast::Integer>(loc, std::stoll(token->get_lexeme()));
+      return std::make_unique<ast::Integer>(loc, static_cast<int64_t>(value.value_or(0)));
     }
     if (match(TokenKind::FLOAT))
     {
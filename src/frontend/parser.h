@@ -77,6 +77,8 @@ namespace aloha
     bool is_reserved_ident(Token t) const;
 
     ast::NodePtr parse_top_level_declaration();
+    std::vector<ast::FunctionAttribute> parse_function_attributes();
+    void check_function_attributes(const ast::Function &func, const Location &loc);
     FunctionSignature parse_function_signature();
     std::unique_ptr<ast::Function> parse_function(bool is_public = false);
     std::unique_ptr<ast::Function> parse_extern_function(bool is_public = false);
@@ -92,8 +94,8 @@ namespace aloha
     std::unique_ptr<ast::Statement> parse_struct_decl(bool is_public = false);
     std::unique_ptr<ast::Statement> parse_enum_decl(bool is_public = false);
     std::unique_ptr<ast::Statement> parse_struct_field_assignment();
-    std::unique_ptr<ast::Statement> parse_variable_declaration();
-    std::unique_ptr<ast::Statement> parse_variable_assignment();
+    std::unique_ptr<ast::Declaration> parse_variable_declaration();
+    std::unique_ptr<ast::Assignment> parse_variable_assignment();
     std::unique_ptr<ast::Statement> parse_array_assignment();
     std::unique_ptr<ast::Statement> parse_return_statement();
     std::unique_ptr<ast::Statement> parse_break_statement();
@@ -101,6 +103,7 @@ namespace aloha
     std::unique_ptr<ast::Statement> parse_if_statement();
     std::unique_ptr<ast::Statement> parse_match_statement();
     std::unique_ptr<ast::Statement> parse_while_loop();
+    std::unique_ptr<ast::Statement> parse_for_loop();
     std::unique_ptr<ast::Statement> parse_identifier_statement();
     bool statement_requires_semicolon(const ast::Statement *stmt) const;
     void consume_statement_semicolon();
@@ -110,6 +113,7 @@ namespace aloha
     std::unique_ptr<ast::Expression> parse_match_expression();
     std::unique_ptr<ast::Expression> parse_match_scrutinee();
     std::optional<ast::MatchPattern> parse_match_pattern();
+    std::optional<int64_t> parse_match_integer();
     std::unique_ptr<ast::Expression> parse_new_object_expression();
     std::unique_ptr<ast::Expression> parse_array();
 
@@ -11,9 +11,12 @@
   X(BANG, "!")           \
   X(AMP, "&")            \
   X(AMP_AMP, "&&")       \
+  X(AT, "@")             \
   X(COLON, ":")          \
   X(DOUBLE_COLON, "::")   \
   X(COMMA, ",")          \
+  X(DOT_DOT, "..")       \
+  X(DOT_DOT_EQUAL, "..=") \
   X(EQUAL_EQUAL, "==")   \
   X(EQUAL, "=")          \
   X(EOF_TOKEN, "EOF")    \
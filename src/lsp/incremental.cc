@@ -0,0 +1,385 @@
+#include "incremental.h"
+#include "../ast/visitor.h"
+
+#include <cctype>
+
+namespace aloha
+{
+  namespace lsp
+  {
+    namespace
+    {
+      // walks text, keeping the document position of the current character
+      struct Cursor
+      {
+        std::string_view text;
+        size_t pos = 0;
+        uint32_t line = 1;
+        uint32_t col = 1;
+
+        bool at_end() const { return pos >= text.size(); }
+        char peek(size_t nth = 0) const
+        {
+          return pos + nth < text.size() ? text[pos + nth] : '\0';
+        }
+
+        void advance()
+        {
+          if (text[pos] == '\n')
+          {
+            ++line;
+            col = 1;
+          }
+          else
+          {
+            ++col;
+          }
+          ++pos;
+        }
+
+        // skips a comment starting here; false if there is none
+        bool skip_comment()
+        {
+          if (peek() == '/' && peek(1) == '/')
+          {
+            while (!at_end() && peek() != '\n')
+              advance();
+            return true;
+          }
+          if (peek() == '/' && peek(1) == '*')
+          {
+            advance();
+            advance();
+            while (!at_end() && !(peek() == '*' && peek(1) == '/'))
+              advance();
+            if (!at_end())
+            {
+              advance();
+              advance();
+            }
+            return true;
+          }
+          return false;
+        }
+
+        // skips a string literal starting here, which the lexer ends at a newline
+        void skip_string()
+        {
+          advance();
+          while (!at_end() && peek() != '"' && peek() != '\n')
+          {
+            if (peek() == '\\' && pos + 1 < text.size() && peek(1) != '\n')
+              advance();
+            advance();
+          }
+          if (peek() == '"')
+            advance();
+        }
+      };
+
+      // attributes and 'pub' may come before 'fun'
+      bool declares_function(std::string_view header)
+      {
+        size_t i = 0;
+        while (i < header.size())
+        {
+          while (i < header.size() && std::isspace(static_cast<unsigned char>(header[i])))
+            ++i;
+          size_t start = i;
+          while (i < header.size() && !std::isspace(static_cast<unsigned char>(header[i])))
+            ++i;
+          std::string_view word = header.substr(start, i - start);
+          if (word.empty() || word == "pub" || word.front() == '@')
+            continue;
+          return word == "fun";
+        }
+        return false;
+      }
+
+      class LineShifter : public ASTVisitor
+      {
+      public:
+        explicit LineShifter(int64_t delta) : delta(delta) {}
+
+        void shift(Location &loc) const { shift_lines(loc, delta); }
+
+        void visit_child(ast::Node *node)
+        {
+          if (node)
+            node->accept(*this);
+        }
+
+        void visit(ast::Integer *node) override { shift(node->m_loc); }
+        void visit(ast::Float *node) override { shift(node->m_loc); }
+        void visit(ast::Boolean *node) override { shift(node->m_loc); }
+        void visit(ast::Null *node) override { shift(node->m_loc); }
+        void visit(ast::String *node) override { shift(node->m_loc); }
+        void visit(ast::Identifier *node) override { shift(node->m_loc); }
+        void visit(ast::BreakStatement *node) override { shift(node->m_loc); }
+        void visit(ast::ContinueStatement *node) override { shift(node->m_loc); }
+        void visit(ast::EnumDecl *node) override { shift(node->m_loc); }
+        void visit(ast::ExternTypeDecl *node) override { shift(node->m_loc); }
+        void visit(ast::Import *node) override { shift(node->m_loc); }
+
+        void visit(ast::UnaryExpression *node) override
+        {
+          shift(node->m_loc);
+          visit_child(node->m_expr.get());
+        }
+
+        void visit(ast::BinaryExpression *node) override
+        {
+          shift(node->m_loc);
+          visit_child(node->m_left.get());
+          visit_child(node->m_right.get());
+        }
+
+        void visit(ast::EnumVariant *node) override
+        {
+          shift(node->m_loc);
+          shift(node->m_path.m_loc);
+        }
+
+        void visit(ast::MatchExpression *node) override
+        {
+          shift(node->m_loc);
+          visit_child(node->m_scrutinee.get());
+          for (auto &arm : node->m_arms)
+          {
+            shift(arm.m_loc);
+            if (arm.m_pattern)
+              shift(arm.m_pattern->m_loc);
+            visit_child(arm.m_value.get());
+          }
+        }
+
+        void visit(ast::Declaration *node) override
+        {
+          shift(node->m_loc);
+          visit_child(node->m_expression.get());
+        }
+
+        void visit(ast::Assignment *node) override
+        {
+          shift(node->m_loc);
+          visit_child(node->m_expression.get());
+        }
+
+        void visit(ast::ArrayAssignment *node) override
+        {
+          shift(node->m_loc);
+          visit_child(node->m_index_expr.get());
+          visit_child(node->m_value.get());
+        }
+
+        void visit(ast::FunctionCall *node) override
+        {
+          shift(node->m_loc);
+          shift(node->m_path.m_loc);
+          for (auto &arg : node->m_arguments)
+            visit_child(arg.get());
+        }
+
+        void visit(ast::ReturnStatement *node) override
+        {
+          shift(node->m_loc);
+          visit_child(node->m_expression.get());
+        }
+
+        void visit(ast::IfStatement *node) override
+        {
+          shift(node->m_loc);
+          visit_child(node->m_condition.get());
+          visit_child(node->m_then_branch.get());
+          visit_child(node->m_else_branch.get());
+        }
+
+        void visit(ast::MatchStatement *node) override
+        {
+          shift(node->m_loc);
+          visit_child(node->m_scrutinee.get());
+          for (auto &arm : node->m_arms)
+          {
+            shift(arm.m_loc);
+            if (arm.m_pattern)
+              shift(arm.m_pattern->m_loc);
+            visit_child(arm.m_body.get());
+          }
+        }
+
+        void visit(ast::WhileLoop *node) override
+        {
+          shift(node->m_loc);
+          visit_child(node->m_condition.get());
+          visit_child(node->m_body.get());
+        }
+
+        void visit(ast::ForLoop *node) override
+        {
+          shift(node->m_loc);
+          visit_child(node->m_initializer.get());
+          visit_child(node->m_condition.get());
+          visit_child(node->m_increment.get());
+          visit_child(node->m_body.get());
+        }
+
+        void visit(ast::Function *node) override
+        {
+          shift(node->m_loc);
+          visit_child(node->m_name.get());
+          for (auto &param : node->m_parameters)
+            shift(param.m_loc);
+          visit_child(node->m_body.get());
+        }
+
+        void visit(ast::StructDecl *node) override
+        {
+          shift(node->m_loc);
+          for (auto &field : node->m_fields)
+            shift(field.m_loc);
+        }
+
+        void visit(ast::StructInstantiation *node) override
+        {
+          shift(node->m_loc);
+          for (auto &field : node->m_field_values)
+            visit_child(field.m_value.get());
+        }
+
+        void visit(ast::NewObjectExpression *node) override
+        {
+          shift(node->m_loc);
+          visit_child(node->m_arena.get());
+          for (auto &field : node->m_field_values)
+            visit_child(field.m_value.get());
+        }
+
+        void visit(ast::StructFieldAccess *node) override
+        {
+          shift(node->m_loc);
+          visit_child(node->m_struct_expr.get());
+        }
+
+        void visit(ast::StructFieldAssignment *node) override
+        {
+          shift(node->m_loc);
+          visit_child(node->m_struct_expr.get());
+          visit_child(node->m_value.get());
+        }
+
+        void visit(ast::Array *node) override
+        {
+          shift(node->m_loc);
+          for (auto &member : node->m_members)
+            visit_child(member.get());
+        }
+
+        void visit(ast::ArrayAccess *node) override
+        {
+          shift(node->m_loc);
+          visit_child(node->m_array_expr.get());
+          visit_child(node->m_index_expr.get());
+        }
+
+        void visit(ast::ExpressionStatement *node) override
+        {
+          shift(node->m_loc);
+          visit_child(node->m_expr.get());
+        }
+
+        void visit(ast::StatementBlock *node) override
+        {
+          shift(node->m_loc);
+          for (auto &stmt : node->m_statements)
+            visit_child(stmt.get());
+        }
+
+        void visit(ast::Program *node) override
+        {
+          shift(node->m_loc);
+          for (auto &child : node->m_nodes)
+            visit_child(child.get());
+        }
+
+      private:
+        int64_t delta;
+      };
+    } // namespace
+
+    std::vector<DeclarationText> split_declarations(std::string_view text)
+    {
+      std::vector<DeclarationText> declarations;
+      Cursor cursor{text};
+
+      while (!cursor.at_end())
+      {
+        if (std::isspace(static_cast<unsigned char>(cursor.peek())))
+        {
+          cursor.advance();
+          continue;
+        }
+        if (cursor.skip_comment())
+          continue;
+
+        DeclarationText decl{"", cursor.line, cursor.col, "", false};
+        size_t start = cursor.pos;
+        size_t body = std::string_view::npos;
+        int depth = 0;
+        bool closed = false;
+        while (!cursor.at_end() && !closed)
+        {
+          if (cursor.skip_comment())
+            continue;
+
+          char c = cursor.peek();
+          if (c == '"')
+          {
+            cursor.skip_string();
+            continue;
+          }
+
+          if (c == '{' || c == '(' || c == '[')
+          {
+            if (c == '{' && depth == 0 && body == std::string_view::npos)
+              body = cursor.pos;
+            ++depth;
+          }
+          else if (c == '}' || c == ')' || c == ']')
+          {
+            if (depth > 0)
+              --depth;
+            closed = depth == 0 && c == '}';
+          }
+          else if (c == ';' && depth == 0)
+          {
+            closed = true;
+          }
+          cursor.advance();
+        }
+
+        decl.text = std::string(text.substr(start, cursor.pos - start));
+        if (body != std::string_view::npos)
+        {
+          decl.header = std::string(text.substr(start, body - start));
+          decl.is_function = closed && declares_function(decl.header);
+        }
+        declarations.push_back(std::move(decl));
+      }
+
+      return declarations;
+    }
+
+    void shift_lines(Location &loc, int64_t delta)
+    {
+      loc.line = static_cast<uint32_t>(static_cast<int64_t>(loc.line) + delta);
+    }
+
+    void shift_lines(ast::Node *node, int64_t delta)
+    {
+      if (!node || delta == 0)
+        return;
+      LineShifter shifter(delta);
+      node->accept(shifter);
+    }
+  } // namespace lsp
+} // namespace aloha
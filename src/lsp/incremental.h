@@ -0,0 +1,40 @@
+#ifndef LSP_INCREMENTAL_H_
+#define LSP_INCREMENTAL_H_
+
+#include "../ast/ast.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace aloha
+{
+  namespace lsp
+  {
+    // The text of one top-level declaration of a document. Comparing these
+    // between two versions of a document tells which declarations an edit
+    // touched.
+    struct DeclarationText
+    {
+      std::string text;
+      uint32_t line; // where text starts in the document
+      uint32_t col;
+      // text before the body of a function, i.e. its attributes and
+      // signature; a function keeps its declaration while this is unchanged
+      std::string header;
+      bool is_function; // a function with a body, not an extern declaration
+    };
+
+    // Splits text after each top-level declaration, at a ';' or a closing
+    // '}' outside any brackets, strings and comments. Comments and blank
+    // lines between declarations belong to none of them.
+    std::vector<DeclarationText> split_declarations(std::string_view text);
+
+    // moves every location in node and its children by delta lines
+    void shift_lines(ast::Node *node, int64_t delta);
+    void shift_lines(Location &loc, int64_t delta);
+  } // namespace lsp
+} // namespace aloha
+
+#endif // LSP_INCREMENTAL_H_
@@ -0,0 +1,920 @@
+#include "server.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <functional>
+#include <iterator>
+#include <string_view>
+#include <vector>
+
+#include <llvm/Support/raw_ostream.h>
+
+namespace aloha
+{
+  namespace lsp
+  {
+    namespace
+    {
+      // JSON-RPC error codes from the LSP specification
+      constexpr int METHOD_NOT_FOUND = -32601;
+
+      struct SymbolInfo
+      {
+        Location location;
+        std::string detail;
+      };
+
+      bool is_ident_char(char c)
+      {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+      }
+
+      std::string function_signature(const FunctionSymbol &func, const TyTable &ty_table)
+      {
+        std::string sig;
+        if (func.is_public)
+          sig += "pub ";
+        if (func.is_extern)
+          sig += "extern ";
+        sig += "fun " + func.name + "(";
+        for (size_t i = 0; i < func.param_types.size(); ++i)
+        {
+          if (i > 0)
+            sig += ", ";
+          sig += ty_table.ty_name(func.param_types[i]);
+        }
+        sig += ") -> " + ty_table.ty_name(func.return_type);
+        return sig;
+      }
+
+      // a is at or before b
+      bool precedes(const Location &a, const Location &b)
+      {
+        return a.line < b.line || (a.line == b.line && a.col <= b.col);
+      }
+
+      // a variable declaration in scope at some position
+      struct VisibleVariable
+      {
+        const std::string *name;
+        Location location;
+      };
+
+      void collect_visible(const ast::StatementBlock *block, const Location &pos,
+                           std::vector<VisibleVariable> &visible);
+
+      // the declarations a statement that contains pos brings into scope there
+      void collect_visible(const ast::Statement *stmt, const Location &pos,
+                           std::vector<VisibleVariable> &visible)
+      {
+        auto enters = [&](const ast::StatementBlock *block)
+        { return block && precedes(block->m_loc, pos); };
+
+        if (auto if_stmt = dynamic_cast<const ast::IfStatement *>(stmt))
+        {
+          if (enters(if_stmt->m_else_branch.get()))
+            collect_visible(if_stmt->m_else_branch.get(), pos, visible);
+          else if (enters(if_stmt->m_then_branch.get()))
+            collect_visible(if_stmt->m_then_branch.get(), pos, visible);
+        }
+        else if (auto while_loop = dynamic_cast<const ast::WhileLoop *>(stmt))
+        {
+          if (enters(while_loop->m_body.get()))
+            collect_visible(while_loop->m_body.get(), pos, visible);
+        }
+        else if (auto for_loop = dynamic_cast<const ast::ForLoop *>(stmt))
+        {
+          if (for_loop->m_initializer)
+            visible.push_back({&for_loop->m_initializer->m_variable_name,
+                               for_loop->m_initializer->m_loc});
+          if (enters(for_loop->m_body.get()))
+            collect_visible(for_loop->m_body.get(), pos, visible);
+        }
+        else if (auto match_stmt = dynamic_cast<const ast::MatchStatement *>(stmt))
+        {
+          const ast::StatementBlock *arm_body = nullptr;
+          for (const auto &arm : match_stmt->m_arms)
+          {
+            if (enters(arm.m_body.get()))
+              arm_body = arm.m_body.get();
+          }
+          if (arm_body)
+            collect_visible(arm_body, pos, visible);
+        }
+      }
+
+      // walks the statements of block up to pos, the same way the binder
+      // nests scopes, so that only declarations visible at pos are kept
+      void collect_visible(const ast::StatementBlock *block, const Location &pos,
+                           std::vector<VisibleVariable> &visible)
+      {
+        const auto &stmts = block->m_statements;
+        for (size_t i = 0; i < stmts.size(); ++i)
+        {
+          const ast::Statement *stmt = stmts[i].get();
+          if (!precedes(stmt->m_loc, pos))
+            break;
+
+          if (auto decl = dynamic_cast<const ast::Declaration *>(stmt))
+          {
+            visible.push_back({&decl->m_variable_name, decl->m_loc});
+            continue;
+          }
+
+          // statements end where the next one starts
+          if (i + 1 == stmts.size() || !precedes(stmts[i + 1]->m_loc, pos))
+          {
+            collect_visible(stmt, pos, visible);
+            break;
+          }
+        }
+      }
+
+      // the function whose text contains pos: the last top-level function
+      // starting before it
+      const ast::Function *enclosing_function(const ast::Program &program, const Location &pos)
+      {
+        const ast::Function *enclosing = nullptr;
+        for (const auto &node : program.m_nodes)
+        {
+          if (!precedes(node->m_loc, pos))
+            break;
+          enclosing = dynamic_cast<const ast::Function *>(node.get());
+        }
+        return enclosing;
+      }
+
+      // local variables resolve through the scopes of the function around
+      // the cursor, innermost declaration first
+      std::optional<SymbolInfo> lookup_variable(const Analysis &analysis,
+                                                const std::string &name,
+                                                const Location &pos)
+      {
+        if (!analysis.ast)
+          return std::nullopt;
+        const ast::Function *func = enclosing_function(*analysis.ast, pos);
+        if (!func)
+          return std::nullopt;
+
+        std::vector<VisibleVariable> visible;
+        for (const auto &param : func->m_parameters)
+          visible.push_back({&param.m_name, param.m_loc});
+        if (func->m_body && !func->m_is_extern)
+          collect_visible(func->m_body.get(), pos, visible);
+
+        for (auto it = visible.rbegin(); it != visible.rend(); ++it)
+        {
+          if (*it->name != name)
+            continue;
+
+          // the binder registered it under its declaration's location
+          for (const auto &[id, var] : analysis.symbols()->variables)
+          {
+            (void)id;
+            if (var.name == name && var.location.line == it->location.line &&
+                var.location.col == it->location.col &&
+                var.location.file_path == it->location.file_path)
+            {
+              return SymbolInfo{var.location,
+                                std::string(var.is_mutable ? "mut " : "imut ") + var.name};
+            }
+          }
+          return std::nullopt;
+        }
+        return std::nullopt;
+      }
+
+      std::optional<SymbolInfo> lookup_symbol(const Analysis &analysis,
+                                              const std::string &word,
+                                              const Location &pos)
+      {
+        const SymbolTable *symbols = analysis.symbols();
+        if (!symbols || word.empty())
+          return std::nullopt;
+
+        std::string name = word;
+        auto sep = word.rfind("::");
+        if (sep != std::string::npos)
+        {
+          std::string qualifier = word.substr(0, sep);
+          name = word.substr(sep + 2);
+          if (auto variant = symbols->lookup_enum_variant(qualifier, name))
+          {
+            return SymbolInfo{variant->location,
+                              "enum " + qualifier + "::" + name + " = " +
+                                  std::to_string(variant->value)};
+          }
+        }
+        else if (auto var = lookup_variable(analysis, name, pos))
+        {
+          return var;
+        }
+
+        if (auto func = symbols->lookup_function(name))
+        {
+          return SymbolInfo{func->location, function_signature(*func, *analysis.ty_table)};
+        }
+        if (auto struct_sym = symbols->lookup_struct(name))
+        {
+          return SymbolInfo{struct_sym->location, "struct " + name};
+        }
+        if (auto enum_sym = symbols->lookup_enum(name))
+        {
+          return SymbolInfo{enum_sym->location, "enum " + name};
+        }
+        if (auto opaque = symbols->lookup_opaque_type(name))
+        {
+          return SymbolInfo{opaque->location, "extern type " + name};
+        }
+        return std::nullopt;
+      }
+
+      // Runs the front end over a whole document; true if it got as far as
+      // type checking the function bodies.
+      bool run_pipeline(Analysis &analysis, const std::string &text, const std::string &path)
+      {
+        analysis.ty_table = std::make_unique<TyTable>();
+        DiagnosticEngine &diagnostics = analysis.diagnostics;
+
+        try
+        {
+          analysis.lexer = std::make_unique<Lexer>(text, path);
+          analysis.parser = std::make_unique<Parser>(*analysis.lexer, analysis.type_arena,
+                                                     diagnostics);
+          analysis.ast = analysis.parser->parse();
+          if (!analysis.ast || diagnostics.has_errors())
+            return false;
+
+          analysis.symbol_binder = std::make_unique<SymbolBinder>(*analysis.ty_table, diagnostics);
+          analysis.import_resolver = std::make_unique<ImportResolver>(
+              *analysis.ty_table, analysis.symbol_binder->get_symbol_table(),
+              analysis.type_arena, diagnostics, path);
+          if (!analysis.import_resolver->resolve_imports(analysis.ast.get()) ||
+              diagnostics.has_errors())
+            return false;
+
+          if (!analysis.symbol_binder->bind(analysis.ast.get(), analysis.type_arena))
+            return false;
+
+          analysis.type_resolver = std::make_unique<TypeResolver>(
+              *analysis.ty_table, analysis.symbol_binder->get_symbol_table(), diagnostics);
+          bool resolved = analysis.type_resolver->resolve(analysis.ast.get(),
+                                                          analysis.type_arena);
+          for (const auto &imported : analysis.import_resolver->get_imported_asts())
+          {
+            resolved = resolved &&
+                       analysis.type_resolver->resolve(imported.get(), analysis.type_arena);
+          }
+          if (!resolved || diagnostics.has_errors())
+            return false;
+
+          // AIR lowering performs type checking, so run it for its diagnostics
+          analysis.air_builder = std::make_unique<AIRBuilder>(
+              *analysis.ty_table, analysis.symbol_binder->get_symbol_table(),
+              analysis.type_resolver->get_resolved_structs(),
+              analysis.type_resolver->get_resolved_functions(),
+              analysis.type_arena, *analysis.type_resolver, diagnostics);
+          analysis.air_builder->build(analysis.ast.get());
+          return true;
+        }
+        catch (const std::exception &e)
+        {
+          diagnostics.error(DiagnosticPhase::Driver, Location(1, 1, path),
+                            "Analysis exception: " + std::string(e.what()));
+        }
+        return false;
+      }
+
+      Location start_of(const DeclarationText &decl)
+      {
+        return Location(decl.line, decl.col, "");
+      }
+
+      // each declaration parsed to the node at the same index
+      bool lines_up(const std::vector<DeclarationText> &texts, const ast::Program &program)
+      {
+        if (texts.size() != program.m_nodes.size())
+          return false;
+
+        for (size_t i = 0; i < texts.size(); ++i)
+        {
+          const ast::Node *node = program.m_nodes[i].get();
+          if (!precedes(start_of(texts[i]), node->m_loc) ||
+              (i + 1 < texts.size() && precedes(start_of(texts[i + 1]), node->m_loc)))
+            return false;
+
+          auto func = dynamic_cast<const ast::Function *>(node);
+          bool has_body = func && func->m_body && !func->m_is_extern;
+          if (has_body != texts[i].is_function)
+            return false;
+        }
+        return true;
+      }
+
+      // Splits the results of a full analysis by declaration, so that a later
+      // edit can replace those of the functions it changed.
+      void record_declarations(Analysis &analysis, const std::string &text,
+                               const std::string &path, bool checked)
+      {
+        std::vector<DeclarationText> texts = split_declarations(text);
+        analysis.incremental = checked && lines_up(texts, *analysis.ast);
+        if (!analysis.incremental)
+        {
+          analysis.document_diagnostics = analysis.diagnostics.all();
+          return;
+        }
+
+        std::vector<DeclarationState> &decls = analysis.declarations;
+        for (auto &source : texts)
+          decls.push_back(DeclarationState{std::move(source), {}, {}, {}});
+
+        // the function a location in this document lies in, if any
+        auto owner = [&](const Location &loc) -> DeclarationState *
+        {
+          if (!loc.file_path || *loc.file_path != path)
+            return nullptr;
+          auto after = std::upper_bound(decls.begin(), decls.end(), loc,
+                                        [](const Location &at, const DeclarationState &decl)
+                                        { return !precedes(start_of(decl.source), at); });
+          if (after == decls.begin())
+            return nullptr;
+          DeclarationState &decl = *std::prev(after);
+          return decl.source.is_function ? &decl : nullptr;
+        };
+
+        for (const auto &[id, var] : analysis.symbols()->variables)
+        {
+          if (DeclarationState *decl = owner(var.location))
+            decl->variables.push_back(id);
+        }
+        for (const auto &diag : analysis.diagnostics.all())
+        {
+          if (DeclarationState *decl = owner(diag.location))
+            decl->diagnostics.push_back(diag);
+          else
+            analysis.document_diagnostics.push_back(diag);
+        }
+      }
+
+      bool same_location(const Location &a, const Location &b)
+      {
+        return a.line == b.line && a.col == b.col && a.file_path == b.file_path;
+      }
+
+      // An unchanged function that an edit above it moved by delta lines.
+      // Its type specs keep their old locations; they are only read while
+      // the function is checked, which happens again after re-parsing.
+      void move_function(Analysis &analysis, DeclarationState &decl, ast::Function *func,
+                         int64_t delta)
+      {
+        SymbolTable &symbols = analysis.symbol_binder->get_symbol_table();
+        auto symbol = symbols.functions.find(func->m_name->m_name);
+        if (symbol != symbols.functions.end() && same_location(symbol->second.location, func->m_loc))
+          shift_lines(symbol->second.location, delta);
+
+        shift_lines(func, delta);
+        for (VarId id : decl.variables)
+        {
+          auto var = symbols.variables.find(id);
+          if (var != symbols.variables.end())
+            shift_lines(var->second.location, delta);
+        }
+        for (auto &diag : decl.diagnostics)
+          shift_lines(diag.location, delta);
+        decl.source.line = static_cast<uint32_t>(decl.source.line + delta);
+      }
+
+      // Re-lexes, re-parses, re-binds and re-checks a function whose body
+      // changed, against the resident declarations of the rest of the
+      // document. Its signature is unchanged, so nothing else needs redoing.
+      void reanalyze_function(Analysis &analysis, DeclarationState &decl, ast::NodePtr &node,
+                              DeclarationText now, const std::string &path)
+      {
+        DiagnosticEngine diagnostics;
+        Lexer lexer(now.text, path, now.line, now.col);
+        Parser parser(lexer, analysis.type_arena, diagnostics);
+        auto program = parser.parse();
+        ast::Function *func = program && program->m_nodes.size() == 1
+                                  ? dynamic_cast<ast::Function *>(program->m_nodes.front().get())
+                                  : nullptr;
+        if (diagnostics.has_errors() || !func || !func->m_body)
+        {
+          decl.syntax_errors = diagnostics.all();
+          if (decl.syntax_errors.empty())
+          {
+            decl.syntax_errors.emplace_back(DiagnosticSeverity::Error, DiagnosticPhase::Parser,
+                                            Location(now.line, now.col, path),
+                                            "Expected a function declaration");
+          }
+          return;
+        }
+        decl.syntax_errors.clear();
+
+        SymbolTable &symbols = analysis.symbol_binder->get_symbol_table();
+        auto *old_func = static_cast<ast::Function *>(node.get());
+        auto symbol = symbols.functions.find(func->m_name->m_name);
+        if (symbol != symbols.functions.end() &&
+            same_location(symbol->second.location, old_func->m_loc))
+          symbol->second.location = func->m_loc;
+
+        for (VarId id : decl.variables)
+          symbols.variables.erase(id);
+        decl.variables.clear();
+        node = std::move(program->m_nodes.front());
+
+        VarId first_var = symbols.next_var_id;
+        SymbolBinder binder(*analysis.ty_table, diagnostics);
+        binder.set_symbol_table(&symbols);
+        binder.bind_function_body(func);
+        for (VarId id = first_var; id < symbols.next_var_id; ++id)
+        {
+          if (symbols.variables.count(id))
+            decl.variables.push_back(id);
+        }
+
+        if (!diagnostics.has_errors())
+        {
+          // a resolver of its own keeps errors in the body's type specs with
+          // this function rather than the document
+          TypeResolver resolver(*analysis.ty_table, symbols, diagnostics);
+          AIRBuilder builder(*analysis.ty_table, symbols,
+                             analysis.type_resolver->get_resolved_structs(),
+                             analysis.type_resolver->get_resolved_functions(),
+                             analysis.type_arena, resolver, diagnostics);
+          builder.build_function(func);
+        }
+
+        decl.diagnostics = diagnostics.all();
+        decl.source = std::move(now);
+      }
+    } // namespace
+
+    Server::Server(std::istream &in, std::ostream &out)
+        : in(in), out(out), shutdown_requested(false) {}
+
+    std::optional<std::string> Server::read_message()
+    {
+      while (in)
+      {
+        size_t content_length = 0;
+        bool valid_length = false;
+        bool saw_header = false;
+        std::string line;
+        while (std::getline(in, line))
+        {
+          if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+          if (line.empty())
+          {
+            if (saw_header)
+              break;
+            continue; // stray blank line between messages
+          }
+          saw_header = true;
+
+          // searched for anywhere in the line, so that after a dropped message
+          // the header that follows its unread body is still found
+          constexpr std::string_view header = "Content-Length:";
+          auto at = line.find(header);
+          if (at != std::string::npos)
+          {
+            std::string_view value(line);
+            value.remove_prefix(at + header.size());
+            while (!value.empty() && (value.front() == ' ' || value.front() == '\t'))
+              value.remove_prefix(1);
+            while (!value.empty() && (value.back() == ' ' || value.back() == '\t'))
+              value.remove_suffix(1);
+            auto [end, ec] = std::from_chars(value.data(), value.data() + value.size(),
+                                             content_length);
+            valid_length = ec == std::errc() && end == value.data() + value.size();
+          }
+        }
+
+        if (!in)
+          return std::nullopt;
+
+        // without a usable length the body cannot be found, so the message is
+        // dropped and the next header block is read
+        if (!valid_length || content_length == 0)
+        {
+          std::cerr << "lsp: skipping message without a valid Content-Length" << std::endl;
+          continue;
+        }
+
+        std::string body(content_length, '\0');
+        in.read(body.data(), static_cast<std::streamsize>(content_length));
+        if (!in)
+          return std::nullopt;
+        return body;
+      }
+      return std::nullopt;
+    }
+
+    void Server::send(llvm::json::Value message)
+    {
+      std::string payload;
+      llvm::raw_string_ostream os(payload);
+      os << message;
+      os.flush();
+
+      out << "Content-Length: " << payload.size() << "\r\n\r\n"
+          << payload;
+      out.flush();
+    }
+
+    void Server::reply(const llvm::json::Value &id, llvm::json::Value result)
+    {
+      send(llvm::json::Object{
+          {"jsonrpc", "2.0"},
+          {"id", id},
+          {"result", std::move(result)},
+      });
+    }
+
+    void Server::reply_error(const llvm::json::Value &id, int code, const std::string &message)
+    {
+      send(llvm::json::Object{
+          {"jsonrpc", "2.0"},
+          {"id", id},
+          {"error", llvm::json::Object{{"code", code}, {"message", message}}},
+      });
+    }
+
+    int Server::run()
+    {
+      while (auto body = read_message())
+      {
+        auto parsed = llvm::json::parse(*body);
+        if (!parsed)
+        {
+          std::cerr << "lsp: malformed message: " << llvm::toString(parsed.takeError())
+                    << std::endl;
+          continue;
+        }
+
+        const llvm::json::Object *message = parsed->getAsObject();
+        if (!message)
+          continue;
+
+        if (!handle(*message))
+          return shutdown_requested ? 0 : 1;
+      }
+      return shutdown_requested ? 0 : 1;
+    }
+
+    bool Server::handle(const llvm::json::Object &message)
+    {
+      auto method_opt = message.getString("method");
+      if (!method_opt)
+        return true;
+
+      std::string method = method_opt->str();
+      const llvm::json::Value *id = message.get("id");
+      static const llvm::json::Value no_id = nullptr;
+      if (!id)
+        id = &no_id;
+      const llvm::json::Object *params = message.getObject("params");
+      static const llvm::json::Object no_params;
+      if (!params)
+        params = &no_params;
+
+      if (method == "initialize")
+      {
+        reply(*id, llvm::json::Object{
+                       {"capabilities",
+                        llvm::json::Object{
+                            {"textDocumentSync", 1}, // full document sync
+                            {"definitionProvider", true},
+                            {"hoverProvider", true},
+                        }},
+                       {"serverInfo", llvm::json::Object{{"name", "aloha"}}},
+                   });
+      }
+      else if (method == "shutdown")
+      {
+        shutdown_requested = true;
+        reply(*id, nullptr);
+      }
+      else if (method == "exit")
+      {
+        return false;
+      }
+      else if (method == "textDocument/didOpen")
+      {
+        if (auto doc = params->getObject("textDocument"))
+        {
+          auto uri = doc->getString("uri");
+          auto text = doc->getString("text");
+          if (uri && text)
+            open_document(uri->str(), text->str());
+        }
+      }
+      else if (method == "textDocument/didChange")
+      {
+        auto doc = params->getObject("textDocument");
+        auto changes = params->getArray("contentChanges");
+        if (doc && changes && !changes->empty())
+        {
+          auto uri = doc->getString("uri");
+          auto change = changes->back().getAsObject();
+          if (uri && change)
+          {
+            if (auto text = change->getString("text"))
+              open_document(uri->str(), text->str());
+          }
+        }
+      }
+      else if (method == "textDocument/didClose")
+      {
+        if (auto doc = params->getObject("textDocument"))
+        {
+          if (auto uri = doc->getString("uri"))
+          {
+            documents.erase(uri->str());
+            send(llvm::json::Object{
+                {"jsonrpc", "2.0"},
+                {"method", "textDocument/publishDiagnostics"},
+                {"params", llvm::json::Object{{"uri", uri->str()},
+                                              {"diagnostics", llvm::json::Array{}}}},
+            });
+          }
+        }
+      }
+      else if (method == "textDocument/definition")
+      {
+        reply(*id, definition(*params));
+      }
+      else if (method == "textDocument/hover")
+      {
+        reply(*id, hover(*params));
+      }
+      else if (message.get("id"))
+      {
+        reply_error(*id, METHOD_NOT_FOUND, "Unsupported method: " + method);
+      }
+
+      return true;
+    }
+
+    void Server::open_document(const std::string &uri, std::string text)
+    {
+      Document &doc = documents[uri];
+      std::size_t hash = std::hash<std::string>{}(text);
+      if (doc.analysis && doc.text_hash == hash)
+      {
+        return; // unchanged content, keep the resident analysis
+      }
+
+      doc.path = uri_to_path(uri);
+      doc.text = std::move(text);
+      doc.text_hash = hash;
+      if (!reanalyze(doc))
+        analyze(doc);
+      publish_diagnostics(uri, doc);
+    }
+
+    void Server::analyze(Document &doc)
+    {
+      auto analysis = std::make_unique<Analysis>();
+      bool checked = run_pipeline(*analysis, doc.text, doc.path);
+      record_declarations(*analysis, doc.text, doc.path, checked);
+      doc.analysis = std::move(analysis);
+    }
+
+    bool Server::reanalyze(Document &doc)
+    {
+      Analysis *analysis = doc.analysis.get();
+      if (!analysis || !analysis->incremental)
+        return false;
+
+      std::vector<DeclarationText> texts = split_declarations(doc.text);
+      std::vector<DeclarationState> &decls = analysis->declarations;
+      if (texts.size() != decls.size())
+        return false;
+
+      // nothing is touched until the edit is known to stay inside function
+      // bodies: any other change can affect every declaration after it
+      for (size_t i = 0; i < texts.size(); ++i)
+      {
+        const DeclarationText &bound = decls[i].source;
+        const DeclarationText &now = texts[i];
+        if (bound.text == now.text)
+        {
+          bool moved = bound.line != now.line || bound.col != now.col;
+          if (moved && (!bound.is_function || bound.col != now.col))
+            return false;
+        }
+        else if (!bound.is_function || !now.is_function || bound.header != now.header)
+        {
+          return false;
+        }
+      }
+
+      for (size_t i = 0; i < texts.size(); ++i)
+      {
+        DeclarationState &decl = decls[i];
+        ast::NodePtr &node = analysis->ast->m_nodes[i];
+        if (decl.source.text != texts[i].text)
+        {
+          reanalyze_function(*analysis, decl, node, std::move(texts[i]), doc.path);
+          continue;
+        }
+
+        decl.syntax_errors.clear();
+        int64_t delta = static_cast<int64_t>(texts[i].line) - decl.source.line;
+        if (delta != 0)
+          move_function(*analysis, decl, static_cast<ast::Function *>(node.get()), delta);
+      }
+      return true;
+    }
+
+    void Server::publish_diagnostics(const std::string &uri, const Document &doc)
+    {
+      llvm::json::Array items;
+      auto add = [&](const Diagnostic &diag)
+      {
+        int severity = 1;
+        switch (diag.severity)
+        {
+        case DiagnosticSeverity::Error:
+          severity = 1;
+          break;
+        case DiagnosticSeverity::Warning:
+          severity = 2;
+          break;
+        case DiagnosticSeverity::Note:
+          severity = 3;
+          break;
+        }
+
+        // problems inside imported files are surfaced at the top of the document
+        Location loc = diag.location;
+        std::string message = diag.message;
+        if (loc.file_path && *loc.file_path != doc.path)
+        {
+          message = loc.to_string() + ": " + message;
+          loc = Location(1, 1, doc.path);
+        }
+
+        items.push_back(llvm::json::Object{
+            {"range", to_range(loc, 1)},
+            {"severity", severity},
+            {"source", "aloha"},
+            {"message", message},
+        });
+      };
+
+      const Analysis &analysis = *doc.analysis;
+      for (const auto &diag : analysis.document_diagnostics)
+        add(diag);
+      for (const auto &decl : analysis.declarations)
+      {
+        for (const auto &diag : decl.syntax_errors.empty() ? decl.diagnostics : decl.syntax_errors)
+          add(diag);
+      }
+
+      send(llvm::json::Object{
+          {"jsonrpc", "2.0"},
+          {"method", "textDocument/publishDiagnostics"},
+          {"params", llvm::json::Object{{"uri", uri}, {"diagnostics", std::move(items)}}},
+      });
+    }
+
+    llvm::json::Value Server::definition(const llvm::json::Object &params)
+    {
+      Document *doc = find_document(params);
+      auto pos = position_of(params);
+      if (!doc || !doc->analysis || !pos)
+        return nullptr;
+
+      std::string word = word_at(doc->text, *pos);
+      auto symbol = lookup_symbol(*doc->analysis, word, *pos);
+      if (!symbol)
+        return nullptr;
+
+      std::string path = symbol->location.file_path.value_or(doc->path);
+      return llvm::json::Object{
+          {"uri", path_to_uri(path)},
+          {"range", to_range(symbol->location, 1)},
+      };
+    }
+
+    llvm::json::Value Server::hover(const llvm::json::Object &params)
+    {
+      Document *doc = find_document(params);
+      auto pos = position_of(params);
+      if (!doc || !doc->analysis || !pos)
+        return nullptr;
+
+      std::string word = word_at(doc->text, *pos);
+      auto symbol = lookup_symbol(*doc->analysis, word, *pos);
+      if (!symbol)
+        return nullptr;
+
+      return llvm::json::Object{
+          {"contents", llvm::json::Object{
+                           {"kind", "markdown"},
+                           {"value", "```aloha\n" + symbol->detail + "\n```"},
+                       }},
+      };
+    }
+
+    Document *Server::find_document(const llvm::json::Object &params)
+    {
+      auto text_document = params.getObject("textDocument");
+      if (!text_document)
+        return nullptr;
+      auto uri = text_document->getString("uri");
+      if (!uri)
+        return nullptr;
+      auto it = documents.find(uri->str());
+      return it == documents.end() ? nullptr : &it->second;
+    }
+
+    std::optional<Location> Server::position_of(const llvm::json::Object &params)
+    {
+      auto position = params.getObject("position");
+      if (!position)
+        return std::nullopt;
+      auto line = position->getInteger("line");
+      auto character = position->getInteger("character");
+      if (!line || !character)
+        return std::nullopt;
+      // LSP positions are zero based, compiler locations are one based
+      return Location(static_cast<uint32_t>(*line + 1), static_cast<uint32_t>(*character + 1), "");
+    }
+
+    std::string Server::word_at(const std::string &text, const Location &pos)
+    {
+      size_t offset = 0;
+      for (uint32_t line = 1; line < pos.line; ++line)
+      {
+        offset = text.find('\n', offset);
+        if (offset == std::string::npos)
+          return "";
+        ++offset;
+      }
+      offset += pos.col - 1;
+      if (offset > text.size())
+        return "";
+
+      auto is_path_char = [&](size_t i)
+      { return is_ident_char(text[i]) || text[i] == ':'; };
+
+      size_t start = offset;
+      while (start > 0 && is_path_char(start - 1))
+        --start;
+      size_t end = offset;
+      while (end < text.size() && is_path_char(end))
+        ++end;
+
+      while (start < end && text[start] == ':')
+        ++start;
+      while (end > start && text[end - 1] == ':')
+        --end;
+      return text.substr(start, end - start);
+    }
+
+    std::string Server::uri_to_path(const std::string &uri)
+    {
+      constexpr std::string_view scheme = "file://";
+      std::string encoded = uri.compare(0, scheme.size(), scheme) == 0
+                                ? uri.substr(scheme.size())
+                                : uri;
+
+      std::string path;
+      for (size_t i = 0; i < encoded.size(); ++i)
+      {
+        if (encoded[i] == '%' && i + 2 < encoded.size() &&
+            std::isxdigit(static_cast<unsigned char>(encoded[i + 1])) &&
+            std::isxdigit(static_cast<unsigned char>(encoded[i + 2])))
+        {
+          path += static_cast<char>(std::stoi(encoded.substr(i + 1, 2), nullptr, 16));
+          i += 2;
+        }
+        else
+        {
+          path += encoded[i];
+        }
+      }
+      return path;
+    }
+
+    std::string Server::path_to_uri(const std::string &path)
+    {
+      return "file://" + path;
+    }
+
+    llvm::json::Object Server::to_range(const Location &loc, std::size_t length)
+    {
+      int64_t line = loc.line > 0 ? static_cast<int64_t>(loc.line) - 1 : 0;
+      int64_t col = loc.col > 0 ? static_cast<int64_t>(loc.col) - 1 : 0;
+      return llvm::json::Object{
+          {"start", llvm::json::Object{{"line", line}, {"character", col}}},
+          {"end", llvm::json::Object{{"line", line},
+                                     {"character", col + static_cast<int64_t>(length)}}},
+      };
+    }
+
+  } // namespace lsp
+} // namespace aloha
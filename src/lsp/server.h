@@ -0,0 +1,124 @@
+#ifndef LSP_SERVER_H_
+#define LSP_SERVER_H_
+
+#include "../ast/ast.h"
+#include "../ast/ty_spec.h"
+#include "../air/builder.h"
+#include "../error/diagnostic.h"
+#include "../error/diagnostic_engine.h"
+#include "../frontend/lexer.h"
+#include "../frontend/parser.h"
+#include "../modules/import_resolver.h"
+#include "../sema/symbol_binder.h"
+#include "../sema/type_resolver.h"
+#include "../ty/ty.h"
+#include "incremental.h"
+
+#include <llvm/Support/JSON.h>
+
+#include <cstddef>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace aloha
+{
+  namespace lsp
+  {
+    // A top-level declaration of an open document and what analysing it
+    // produced, kept so that a function whose body alone changed can be
+    // analysed again on its own.
+    struct DeclarationState
+    {
+      DeclarationText source; // the text the resident AST was parsed from
+      std::vector<VarId> variables;
+      std::vector<Diagnostic> diagnostics;
+      // reported for newer text that does not parse; the resident AST stays
+      // the last one that did
+      std::vector<Diagnostic> syntax_errors;
+    };
+
+    // Front-end state for one open document. Kept alive between requests so
+    // that definition and hover lookups are answered from the resident
+    // symbol and type tables instead of re-running the pipeline, and between
+    // edits so that only the functions an edit touched are analysed again.
+    struct Analysis
+    {
+      DiagnosticEngine diagnostics;
+      TySpecArena type_arena;
+      std::unique_ptr<TyTable> ty_table;
+      std::unique_ptr<Lexer> lexer;
+      std::unique_ptr<Parser> parser;
+      std::unique_ptr<ast::Program> ast;
+      std::unique_ptr<SymbolBinder> symbol_binder;
+      std::unique_ptr<ImportResolver> import_resolver;
+      std::unique_ptr<TypeResolver> type_resolver;
+      std::unique_ptr<AIRBuilder> air_builder;
+
+      // set when the whole pipeline ran and the declarations line up with
+      // the nodes of the AST, one for one
+      bool incremental = false;
+      std::vector<DeclarationState> declarations;
+      // diagnostics outside any function body
+      std::vector<Diagnostic> document_diagnostics;
+
+      const SymbolTable *symbols() const
+      {
+        return symbol_binder ? &symbol_binder->get_symbol_table() : nullptr;
+      }
+    };
+
+    struct Document
+    {
+      std::string path;
+      std::string text;
+      std::size_t text_hash = 0;
+      std::unique_ptr<Analysis> analysis;
+    };
+
+    // Minimal language server speaking JSON-RPC over stdio. Supports
+    // diagnostics, go-to-definition and hover.
+    class Server
+    {
+    public:
+      Server(std::istream &in, std::ostream &out);
+      int run();
+
+    private:
+      std::istream &in;
+      std::ostream &out;
+      std::unordered_map<std::string, Document> documents;
+      bool shutdown_requested;
+
+      std::optional<std::string> read_message();
+      void send(llvm::json::Value message);
+      void reply(const llvm::json::Value &id, llvm::json::Value result);
+      void reply_error(const llvm::json::Value &id, int code, const std::string &message);
+
+      // returns false once the client asked the server to exit
+      bool handle(const llvm::json::Object &message);
+
+      void open_document(const std::string &uri, std::string text);
+      void analyze(Document &doc);
+      // re-analyses the functions whose bodies changed; false if the edit
+      // touched anything else, which needs analyze
+      bool reanalyze(Document &doc);
+      void publish_diagnostics(const std::string &uri, const Document &doc);
+
+      llvm::json::Value definition(const llvm::json::Object &params);
+      llvm::json::Value hover(const llvm::json::Object &params);
+
+      Document *find_document(const llvm::json::Object &params);
+      static std::optional<Location> position_of(const llvm::json::Object &params);
+      static std::string word_at(const std::string &text, const Location &pos);
+      static std::string uri_to_path(const std::string &uri);
+      static std::string path_to_uri(const std::string &path);
+      static llvm::json::Object to_range(const Location &loc, std::size_t length);
+    };
+  } // namespace lsp
+} // namespace aloha
+
+#endif // LSP_SERVER_H_
@@ -1,29 +1,38 @@
 #include "compiler/driver.h"
+#include "compiler/watch.h"
+#include "lsp/server.h"
 #include <iostream>
 #include <cstring>
 
 void print_help()
 {
   std::cout << "\nAloha Programming Language Compiler\n\n"
-            << "Usage: aloha [filepath] [options]\n\n"
+            << "Usage: aloha [filepath] [options]\n"
+            << "       aloha watch [filepath] [options]\n"
+            << "       aloha lsp                Run the language server over stdio\n\n"
             << "Options:\n"
             << "  --help, -h          Show this help message\n"
             << "  --version           Show version information\n"
             << "  --verbose, -v       Enable verbose output\n"
             << "  --output, -o FILE   Specify output file\n"
             << "  --optimize, -O      Enable LLVM optimizations\n"
+            << "  --release           Compile out assert and assert_msg\n"
             << "  --dump-ast          Print the abstract syntax tree\n"
             << "  --dump-air          Print the AIR intermediate representation\n"
+            << "  --remarks           Report optimization decisions made on AIR\n"
             << "  --dump-ir           Print the LLVM IR to console\n"
             << "  --emit-llvm         Write LLVM IR to .ll file\n"
             << "  --emit-object       Write object file (.o) [default: true]\n"
+            << "  --emit-interface    Write module interface (.aloi) and bitcode (.bc) next to the object file\n"
             << "  --no-link           Skip linking (object file only)\n\n"
             << "Examples:\n"
             << "  aloha program.alo              Compile and link program\n"
             << "  aloha program.alo -o myapp     Compile with custom output name\n"
             << "  aloha program.alo -O           Compile with optimizations\n"
+            << "  aloha program.alo -O --release Compile with optimizations and without asserts\n"
             << "  aloha program.alo --dump-ir    View generated LLVM IR\n"
-            << "  aloha program.alo --verbose    Show detailed compilation steps\n";
+            << "  aloha program.alo --verbose    Show detailed compilation steps\n"
+            << "  aloha watch program.alo        Recompile whenever a source file changes\n";
 }
 
 void print_version()
@@ -60,10 +69,29 @@ int main(int argc, char *argv[])
       return 0;
     }
 
+    if (first_arg == "lsp")
+    {
+      aloha::lsp::Server server(std::cin, std::cout);
+      return server.run();
+    }
+
+    bool watch_mode = false;
+    int arg_index = 1;
+    if (first_arg == "watch")
+    {
+      if (argc < 3)
+      {
+        std::cerr << "ERROR: watch requires an input file" << std::endl;
+        return 1;
+      }
+      watch_mode = true;
+      arg_index = 2;
+    }
+
     // first argument is the input file
-    options.input_file = argv[1];
+    options.input_file = argv[arg_index];
 
-    for (int i = 2; i < argc; ++i)
+    for (int i = arg_index + 1; i < argc; ++i)
     {
       std::string arg = argv[i];
 
@@ -85,6 +113,10 @@ int main(int argc, char *argv[])
       {
         options.dump_air = true;
       }
+      else if (arg == "--remarks")
+      {
+        options.print_remarks = true;
+      }
       else if (arg == "--dump-ir")
       {
         options.dump_ir = true;
@@ -97,6 +129,10 @@ int main(int argc, char *argv[])
       {
         options.emit_object = true;
       }
+      else if (arg == "--emit-interface")
+      {
+        options.emit_interface = true;
+      }
       else if (arg == "--no-link")
       {
         options.emit_executable = false;
@@ -105,6 +141,10 @@ int main(int argc, char *argv[])
       {
         options.enable_optimization = true;
       }
+      else if (arg == "--release")
+      {
+        options.release = true;
+      }
       else if (arg == "--output" || arg == "-o")
       {
         if (i + 1 < argc)
@@ -129,6 +169,12 @@ int main(int argc, char *argv[])
       }
     }
 
+    if (watch_mode)
+    {
+      aloha::Watcher watcher(options);
+      return watcher.run();
+    }
+
     aloha::CompilerDriver driver(options);
     return driver.compile();
   }
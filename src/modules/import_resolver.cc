@@ -1,4 +1,6 @@
 #include "import_resolver.h"
+#include "interface.h"
+#include "references.h"
 #include "../utils/paths.h"
 #include <fstream>
 #include <iostream>
@@ -18,6 +20,7 @@ namespace aloha
         type_arena(type_arena),
         diagnostics(diag),
         skip_prelude_injection(skip_prelude_injection),
+        current_file_path(current_file_path),
         currently_importing(new std::unordered_set<std::string>()),
         already_imported(new std::unordered_set<std::string>()),
         owns_import_sets(true)
@@ -55,6 +58,10 @@ namespace aloha
     if (!stdlib.empty() && std::filesystem::exists(stdlib))
     {
       search_paths.push_back(stdlib);
+
+      auto stdlib_paths = aloha::utils::get_stdlib_paths();
+      stdlib_source_dir = normalize_path(stdlib_paths.source_dir);
+      stdlib_interface_dir = stdlib_paths.interface_dir;
     }
   }
 
@@ -79,7 +86,18 @@ namespace aloha
     }
   }
 
-  bool ImportResolver::inject_prelude()
+  bool ImportResolver::is_stdlib_module(const std::string &file_path) const
+  {
+    if (stdlib_source_dir.empty())
+    {
+      return false;
+    }
+
+    auto relative = std::filesystem::path(normalize_path(file_path)).lexically_relative(stdlib_source_dir);
+    return !relative.empty() && *relative.begin() != "..";
+  }
+
+  bool ImportResolver::inject_prelude(const ast::Program &program)
   {
     std::string prelude_path = "stdlib/prelude.alo";
     Location prelude_loc;
@@ -91,31 +109,61 @@ namespace aloha
       return false;
     }
 
-    std::string normalized_path = normalize_path(file_path);
-
-    if (already_imported->count(normalized_path) > 0)
-    {
-      return true;
-    }
-
-    if (currently_importing->count(normalized_path) > 0)
+    auto prelude = load_module(normalize_path(file_path), prelude_loc);
+    if (!prelude)
     {
-      diagnostics.error(DiagnosticPhase::SymbolBinding, prelude_loc, "Circular import detected in prelude: '" + prelude_path + "'");
       return false;
     }
 
-    // mark as importing and process
-    currently_importing->insert(normalized_path);
-    bool success = process_imported_file(normalized_path, prelude_loc);
-    currently_importing->erase(normalized_path);
+    // the prelude is imported lazily: only the modules that define a name the
+    // program refers to are bound and compiled, their own dependencies follow
+    // through their explicit imports
+    auto referenced = collect_referenced_names(program, type_arena);
 
-    if (success)
+    for (const auto &node : prelude->m_nodes)
     {
-      already_imported->insert(normalized_path);
-      resolved_import_paths.push_back(normalized_path);
+      auto *import_node = dynamic_cast<ast::Import *>(node.get());
+      if (!import_node)
+      {
+        continue;
+      }
+
+      std::string module_path = resolve_import_path(import_node->m_path, prelude_loc);
+      if (module_path.empty())
+      {
+        diagnostics.error(DiagnosticPhase::SymbolBinding, prelude_loc, "Cannot find prelude module: '" + import_node->m_path + "'");
+        return false;
+      }
+
+      std::string normalized_path = normalize_path(module_path);
+      if (already_imported->count(normalized_path) > 0)
+      {
+        continue;
+      }
+
+      auto module = load_module(normalized_path, prelude_loc);
+      if (!module)
+      {
+        return false;
+      }
+
+      bool needed = false;
+      for (const auto &name : collect_public_names(*module))
+      {
+        if (referenced.count(name) > 0)
+        {
+          needed = true;
+          break;
+        }
+      }
+
+      if (needed && !import_module(normalized_path, prelude_loc, std::move(module)))
+      {
+        return false;
+      }
     }
 
-    return success;
+    return true;
   }
 
   bool ImportResolver::resolve_imports(ast::Program *ast)
@@ -125,10 +173,12 @@ namespace aloha
       return false;
     }
 
-    // inject prelude for top-level program
-    if (!skip_prelude_injection)
+    // inject the prelude parts this file refers to. stdlib modules import
+    // their dependencies explicitly and are part of the prelude themselves, so
+    // they are compiled without it
+    if (!skip_prelude_injection && !is_stdlib_module(current_file_path))
     {
-      if (!inject_prelude())
+      if (!inject_prelude(*ast))
       {
         return false;
       }
@@ -185,20 +235,42 @@ namespace aloha
       return true;
     }
 
+    auto program = load_module(normalized_path, import_loc);
+    if (!program)
+    {
+      return false;
+    }
+
+    return import_module(normalized_path, import_loc, std::move(program));
+  }
+
+  bool ImportResolver::import_module(const std::string &normalized_path,
+                                     const Location &import_loc,
+                                     std::unique_ptr<ast::Program> program)
+  {
+    if (already_imported->count(normalized_path) > 0)
+    {
+      return true;
+    }
+
     if (currently_importing->count(normalized_path) > 0)
     {
-      diagnostics.error(DiagnosticPhase::SymbolBinding, import_loc, "Circular import detected: '" + import_path + "'");
+      diagnostics.error(DiagnosticPhase::SymbolBinding, import_loc, "Circular import detected: '" + normalized_path + "'");
       return false;
     }
 
     currently_importing->insert(normalized_path);
-    bool success = process_imported_file(normalized_path, import_loc);
+    bool success = process_imported_file(normalized_path, import_loc, std::move(program));
     currently_importing->erase(normalized_path);
 
     if (success)
     {
       already_imported->insert(normalized_path);
       resolved_import_paths.push_back(normalized_path);
+      if (parsed_modules.count(normalized_path) > 0 && !is_stdlib_module(normalized_path))
+      {
+        compiled_import_paths.push_back(normalized_path);
+      }
     }
 
     return success;
@@ -226,16 +298,22 @@ namespace aloha
     return "";
   }
 
-  bool ImportResolver::process_imported_file(const std::string &file_path,
-                                             const Location &import_loc)
+  std::unique_ptr<ast::Program> ImportResolver::load_module(const std::string &file_path,
+                                                            const Location &import_loc)
   {
     try
     {
+      std::unique_ptr<ast::Program> program = load_interface(file_path, import_loc);
+      if (program)
+      {
+        return program;
+      }
+
       std::ifstream file(file_path);
       if (!file.is_open())
       {
         diagnostics.error(DiagnosticPhase::SymbolBinding, import_loc, "Cannot open import file: '" + file_path + "'");
-        return false;
+        return nullptr;
       }
 
       std::string source((std::istreambuf_iterator<char>(file)),
@@ -244,25 +322,47 @@ namespace aloha
 
       if (source.empty())
       {
-        return true;
+        return std::make_unique<ast::Program>(Location(1, 1, file_path));
       }
 
       Lexer lexer(source, file_path);
       Parser parser(lexer, type_arena, diagnostics);
 
-      std::unique_ptr<ast::Program> imported_ast = parser.parse();
-      if (!imported_ast || diagnostics.has_errors())
+      program = parser.parse();
+      if (!program || diagnostics.has_errors())
       {
         diagnostics.error(DiagnosticPhase::SymbolBinding, import_loc, "Failed to parse import: '" + file_path + "'");
-        return false;
+        return nullptr;
+      }
+      parsed_modules.insert(file_path);
+      return program;
+    }
+    catch (const std::exception &e)
+    {
+      diagnostics.error(DiagnosticPhase::SymbolBinding, import_loc, "Exception while processing import '" + file_path + "': " + std::string(e.what()));
+      return nullptr;
+    }
+  }
+
+  bool ImportResolver::process_imported_file(const std::string &file_path,
+                                             const Location &import_loc,
+                                             std::unique_ptr<ast::Program> imported_ast)
+  {
+    try
+    {
+      if (imported_ast->m_nodes.empty())
+      {
+        return true;
       }
 
-      ImportResolver nested_resolver(ty_table, main_symbol_table, type_arena, diagnostics, file_path, true);
+      // user modules pull in the prelude parts they refer to themselves
+      ImportResolver nested_resolver(ty_table, main_symbol_table, type_arena, diagnostics, file_path);
 
       // share import tracking sets with nested resolver
       nested_resolver.currently_importing = this->currently_importing;
       nested_resolver.already_imported = this->already_imported;
       nested_resolver.owns_import_sets = false;
+      nested_resolver.module_cache_dir = module_cache_dir;
 
       if (!nested_resolver.resolve_imports(imported_ast.get()))
       {
@@ -293,6 +393,24 @@ namespace aloha
       }
       nested_resolver.resolved_import_paths.clear();
 
+      for (auto &object : nested_resolver.interface_objects)
+      {
+        interface_objects.push_back(std::move(object));
+      }
+      nested_resolver.interface_objects.clear();
+
+      for (auto &bitcode : nested_resolver.interface_bitcode)
+      {
+        interface_bitcode.push_back(std::move(bitcode));
+      }
+      nested_resolver.interface_bitcode.clear();
+
+      for (auto &path : nested_resolver.compiled_import_paths)
+      {
+        compiled_import_paths.push_back(std::move(path));
+      }
+      nested_resolver.compiled_import_paths.clear();
+
       return true;
     }
     catch (const std::exception &e)
@@ -302,4 +420,82 @@ namespace aloha
     }
   }
 
+  std::unique_ptr<ast::Program> ImportResolver::load_interface(const std::string &file_path,
+                                                               const Location &import_loc)
+  {
+    std::filesystem::path interface_path(file_path);
+    interface_path.replace_extension(INTERFACE_EXTENSION);
+
+    // stdlib modules are precompiled by the build; their objects live in the
+    // runtime archive, which is always linked
+    bool in_stdlib_archive = false;
+    if (!std::filesystem::exists(interface_path) && is_stdlib_module(file_path))
+    {
+      interface_path = stdlib_interface_dir /
+                       std::filesystem::path(file_path).lexically_relative(stdlib_source_dir);
+      interface_path.replace_extension(INTERFACE_EXTENSION);
+      in_stdlib_archive = true;
+    }
+    else if (!std::filesystem::exists(interface_path) && !module_cache_dir.empty())
+    {
+      interface_path = module_cache_dir / (module_cache_stem(file_path) + INTERFACE_EXTENSION);
+    }
+
+    // an interface is only usable while it is at least as new as its source
+    std::error_code ec;
+    auto interface_time = std::filesystem::last_write_time(interface_path, ec);
+    if (ec || interface_time < std::filesystem::last_write_time(file_path, ec) || ec)
+    {
+      return nullptr;
+    }
+
+    try
+    {
+      ModuleInterface iface = read_module_interface(interface_path.string(), file_path, type_arena);
+
+      // the object was compiled against these sources; a changed struct
+      // layout or signature in one of them would no longer match it
+      if (const InterfaceDependency *changed = changed_dependency(iface))
+      {
+        diagnostics.warning(DiagnosticPhase::ImportResolution, import_loc,
+                            "Ignoring interface '" + interface_path.string() + "': '" +
+                                changed->source_file + "' changed since it was written");
+        return nullptr;
+      }
+
+      std::filesystem::path bitcode_path(interface_path);
+      bitcode_path.replace_extension(BITCODE_EXTENSION);
+      bool has_bitcode = std::filesystem::exists(bitcode_path);
+      if (in_stdlib_archive)
+      {
+        if (has_bitcode)
+        {
+          interface_bitcode.push_back(bitcode_path.string());
+        }
+        return std::move(iface.program);
+      }
+
+      if (!std::filesystem::exists(iface.object_file))
+      {
+        diagnostics.warning(DiagnosticPhase::ImportResolution, import_loc,
+                            "Ignoring interface '" + interface_path.string() +
+                                "': object file '" + iface.object_file + "' not found");
+        return nullptr;
+      }
+
+      interface_objects.push_back(iface.object_file);
+      if (has_bitcode)
+      {
+        interface_bitcode.push_back(bitcode_path.string());
+      }
+      return std::move(iface.program);
+    }
+    catch (const std::exception &e)
+    {
+      diagnostics.warning(DiagnosticPhase::ImportResolution, import_loc,
+                          std::string(e.what()) + ", falling back to source");
+      return nullptr;
+    }
+  }
+
 } // namespace aloha
@@ -30,7 +30,8 @@ namespace aloha
 
     bool resolve_imports(ast::Program *ast);
 
-    bool inject_prelude();
+    // imports the prelude modules defining names that program refers to
+    bool inject_prelude(const ast::Program &program);
 
     bool has_errors() const { return diagnostics.has_errors(); }
 
@@ -44,6 +45,32 @@ namespace aloha
       return imported_asts;
     }
 
+    // object files of imports that were satisfied by a compiled interface
+    const std::vector<std::string> &get_interface_objects() const
+    {
+      return interface_objects;
+    }
+
+    // bitcode written next to those interfaces, for inlining across modules
+    const std::vector<std::string> &get_interface_bitcode() const
+    {
+      return interface_bitcode;
+    }
+
+    // imports outside the stdlib that were parsed from source rather than
+    // read from an interface, dependencies first
+    const std::vector<std::string> &get_compiled_import_paths() const
+    {
+      return compiled_import_paths;
+    }
+
+    // also look for the interfaces of non-stdlib imports in dir, under
+    // module_cache_stem() of their source
+    void set_module_cache_dir(const std::filesystem::path &dir) { module_cache_dir = dir; }
+
+    // whether file_path lies in the stdlib source tree
+    bool is_stdlib_module(const std::string &file_path) const;
+
   private:
     TyTable &ty_table;
     SymbolTable &main_symbol_table;
@@ -51,8 +78,12 @@ namespace aloha
     DiagnosticEngine &diagnostics;
 
     bool skip_prelude_injection;
+    std::string current_file_path;
     std::filesystem::path current_file_dir;
     std::vector<std::filesystem::path> search_paths;
+    std::filesystem::path stdlib_source_dir;
+    std::filesystem::path stdlib_interface_dir;
+    std::filesystem::path module_cache_dir;
 
     // circular import detection - shared across all nested resolvers
     std::unordered_set<std::string> *currently_importing;
@@ -63,13 +94,32 @@ namespace aloha
 
     std::vector<std::unique_ptr<ast::Program>> imported_asts;
 
+    std::vector<std::string> interface_objects;
+
+    std::vector<std::string> interface_bitcode;
+
+    std::vector<std::string> compiled_import_paths;
+    // modules load_module parsed from source
+    std::unordered_set<std::string> parsed_modules;
+
     bool resolve_import(ast::Import *import_node);
 
     std::string resolve_import_path(const std::string &import_path,
                                     const Location &loc);
 
+    bool import_module(const std::string &normalized_path, const Location &import_loc,
+                       std::unique_ptr<ast::Program> program);
+
+    // reads a module from its interface when one is current, else parses it
+    std::unique_ptr<ast::Program> load_module(const std::string &file_path,
+                                              const Location &import_loc);
+
     bool process_imported_file(const std::string &file_path,
-                               const Location &import_loc);
+                               const Location &import_loc,
+                               std::unique_ptr<ast::Program> imported_ast);
+
+    std::unique_ptr<ast::Program> load_interface(const std::string &file_path,
+                                                 const Location &import_loc);
 
     void initialize_search_paths();
 
@@ -0,0 +1,477 @@
+#include "interface.h"
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iterator>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace aloha
+{
+  namespace
+  {
+    constexpr char MAGIC[4] = {'A', 'L', 'O', 'I'};
+    constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ULL;
+    constexpr uint64_t FNV_PRIME = 0x100000001b3ULL;
+
+    enum class DeclTag : uint8_t
+    {
+      Struct = 1,
+      Enum = 2,
+      ExternType = 3,
+      Function = 4,
+    };
+
+    class InterfaceWriter
+    {
+    public:
+      explicit InterfaceWriter(const TySpecArena &arena) : arena(arena) {}
+
+      void u8(uint8_t value) { buffer.push_back(static_cast<char>(value)); }
+
+      void u32(uint32_t value)
+      {
+        for (int shift = 0; shift < 32; shift += 8)
+          u8(static_cast<uint8_t>(value >> shift));
+      }
+
+      void u64(uint64_t value)
+      {
+        for (int shift = 0; shift < 64; shift += 8)
+          u8(static_cast<uint8_t>(value >> shift));
+      }
+
+      void str(const std::string &value)
+      {
+        u32(static_cast<uint32_t>(value.size()));
+        buffer.append(value);
+      }
+
+      // interns a type spec (and its element types) into the type table and
+      // returns its interface-local index
+      uint32_t type(TySpecId id)
+      {
+        std::string key = arena.to_string(id);
+        auto it = type_indices.find(key);
+        if (it != type_indices.end())
+          return it->second;
+
+        const TySpec &spec = arena[id];
+        InterfaceWriter entry(arena);
+        entry.u8(static_cast<uint8_t>(spec.kind));
+        switch (spec.kind)
+        {
+        case TySpec::Kind::Builtin:
+          entry.u8(static_cast<uint8_t>(spec.builtin));
+          break;
+        case TySpec::Kind::Named:
+          entry.str(spec.name);
+          break;
+        case TySpec::Kind::Array:
+          entry.u32(type(spec.element));
+          entry.u8(spec.size.has_value() ? 1 : 0);
+          entry.u64(spec.size.value_or(0));
+          break;
+        case TySpec::Kind::Ref:
+          entry.u32(type(spec.element));
+          break;
+        }
+
+        uint32_t index = static_cast<uint32_t>(type_entries.size());
+        type_entries.push_back(std::move(entry.buffer));
+        type_indices.emplace(key, index);
+        return index;
+      }
+
+      void decl_header(DeclTag tag, bool is_public, const Location &loc, const std::string &name)
+      {
+        u8(static_cast<uint8_t>(tag));
+        u8(is_public ? 1 : 0);
+        u32(loc.line);
+        u32(loc.col);
+        str(name);
+      }
+
+      // layout: magic, version, header, type table, declarations
+      std::string finish(const std::string &header, uint32_t decl_count)
+      {
+        InterfaceWriter out(arena);
+        out.buffer.append(MAGIC, sizeof(MAGIC));
+        out.u32(INTERFACE_VERSION);
+        out.buffer.append(header);
+        out.u32(static_cast<uint32_t>(type_entries.size()));
+        for (const auto &entry : type_entries)
+          out.buffer.append(entry);
+        out.u32(decl_count);
+        out.buffer.append(buffer);
+        return out.buffer;
+      }
+
+      std::string buffer;
+
+    private:
+      const TySpecArena &arena;
+      std::unordered_map<std::string, uint32_t> type_indices;
+      std::vector<std::string> type_entries;
+    };
+
+    class InterfaceReader
+    {
+    public:
+      InterfaceReader(const std::string &data, const std::string &path)
+          : data(data), path(path), pos(0) {}
+
+      uint8_t u8()
+      {
+        require(1);
+        return static_cast<uint8_t>(data[pos++]);
+      }
+
+      uint32_t u32()
+      {
+        uint32_t value = 0;
+        for (int shift = 0; shift < 32; shift += 8)
+          value |= static_cast<uint32_t>(u8()) << shift;
+        return value;
+      }
+
+      uint64_t u64()
+      {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 8)
+          value |= static_cast<uint64_t>(u8()) << shift;
+        return value;
+      }
+
+      std::string str()
+      {
+        uint32_t len = u32();
+        require(len);
+        std::string value = data.substr(pos, len);
+        pos += len;
+        return value;
+      }
+
+      void expect_magic()
+      {
+        require(sizeof(MAGIC));
+        if (data.compare(0, sizeof(MAGIC), MAGIC, sizeof(MAGIC)) != 0)
+          fail("not a module interface");
+        pos += sizeof(MAGIC);
+      }
+
+      [[noreturn]] void fail(const std::string &reason) const
+      {
+        throw std::runtime_error("Invalid interface file '" + path + "': " + reason);
+      }
+
+    private:
+      const std::string &data;
+      const std::string &path;
+      size_t pos;
+
+      void require(size_t count) const
+      {
+        if (pos + count > data.size())
+          fail("unexpected end of file");
+      }
+    };
+  } // namespace
+
+  void write_module_interface(const std::string &path, const ast::Program &program,
+                              const TySpecArena &type_arena,
+                              const std::string &source_file,
+                              const std::string &object_file,
+                              const std::vector<InterfaceDependency> &dependencies)
+  {
+    InterfaceWriter writer(type_arena);
+    uint32_t decl_count = 0;
+    std::vector<std::string> imports;
+
+    for (const auto &node : program.m_nodes)
+    {
+      if (auto import_node = dynamic_cast<ast::Import *>(node.get()))
+      {
+        imports.push_back(import_node->m_path);
+      }
+      else if (auto struct_decl = dynamic_cast<ast::StructDecl *>(node.get()))
+      {
+        // private structs are kept so public signatures that mention them
+        // still lay out identically in the importing module
+        writer.decl_header(DeclTag::Struct, struct_decl->m_is_public, struct_decl->m_loc,
+                           struct_decl->m_name);
+        writer.u32(static_cast<uint32_t>(struct_decl->m_fields.size()));
+        for (const auto &field : struct_decl->m_fields)
+        {
+          writer.str(field.m_name);
+          writer.u32(writer.type(field.m_type));
+        }
+        ++decl_count;
+      }
+      else if (auto enum_decl = dynamic_cast<ast::EnumDecl *>(node.get()))
+      {
+        writer.decl_header(DeclTag::Enum, enum_decl->m_is_public, enum_decl->m_loc,
+                           enum_decl->m_name);
+        writer.u32(static_cast<uint32_t>(enum_decl->m_variants.size()));
+        for (const auto &variant : enum_decl->m_variants)
+          writer.str(variant);
+        ++decl_count;
+      }
+      else if (auto extern_type = dynamic_cast<ast::ExternTypeDecl *>(node.get()))
+      {
+        writer.decl_header(DeclTag::ExternType, extern_type->m_is_public, extern_type->m_loc,
+                           extern_type->m_name);
+        ++decl_count;
+      }
+      else if (auto func = dynamic_cast<ast::Function *>(node.get()))
+      {
+        if (!func->m_is_public)
+          continue;
+
+        writer.decl_header(DeclTag::Function, true, func->m_loc, func->m_name->m_name);
+        writer.u8(func->m_is_extern ? 1 : 0);
+        writer.u32(writer.type(func->m_return_type));
+        writer.u32(static_cast<uint32_t>(func->m_parameters.size()));
+        for (const auto &param : func->m_parameters)
+        {
+          writer.str(param.m_name);
+          writer.u32(writer.type(param.m_type));
+        }
+        writer.u8(static_cast<uint8_t>(func->m_attributes.size()));
+        for (ast::FunctionAttribute attribute : func->m_attributes)
+          writer.u8(static_cast<uint8_t>(attribute));
+        ++decl_count;
+      }
+    }
+
+    InterfaceWriter header(type_arena);
+    header.str(source_file);
+    header.str(object_file);
+    header.u32(static_cast<uint32_t>(imports.size()));
+    for (const auto &import_path : imports)
+      header.str(import_path);
+
+    header.u32(static_cast<uint32_t>(dependencies.size()));
+    for (const auto &dependency : dependencies)
+    {
+      header.str(dependency.source_file);
+      header.u64(dependency.content_hash);
+    }
+
+    std::string contents = writer.finish(header.buffer, decl_count);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open())
+    {
+      throw std::runtime_error("Could not open file: " + path);
+    }
+    out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    if (!out)
+    {
+      throw std::runtime_error("Failed to write interface file: " + path);
+    }
+  }
+
+  ModuleInterface read_module_interface(const std::string &path, const std::string &source_file,
+                                        TySpecArena &type_arena)
+  {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+      throw std::runtime_error("Could not open file: " + path);
+    }
+    std::string data((std::istreambuf_iterator<char>(file)),
+                     std::istreambuf_iterator<char>());
+
+    InterfaceReader reader(data, path);
+    reader.expect_magic();
+    uint32_t version = reader.u32();
+    if (version != INTERFACE_VERSION)
+    {
+      reader.fail("unsupported version " + std::to_string(version));
+    }
+
+    ModuleInterface iface;
+    iface.source_file = reader.str();
+    iface.object_file = reader.str();
+    if (std::filesystem::path(iface.object_file).is_relative())
+    {
+      iface.object_file = (std::filesystem::path(path).parent_path() / iface.object_file)
+                              .lexically_normal()
+                              .string();
+    }
+
+    // declarations are attributed to the source the import resolved to, which
+    // may have moved since the interface was written (e.g. an installed stdlib)
+    iface.program = std::make_unique<ast::Program>(Location(1, 1, source_file));
+
+    uint32_t import_count = reader.u32();
+    for (uint32_t i = 0; i < import_count; ++i)
+    {
+      iface.program->m_nodes.push_back(
+          std::make_unique<ast::Import>(Location(1, 1, source_file), reader.str()));
+    }
+
+    uint32_t dependency_count = reader.u32();
+    for (uint32_t i = 0; i < dependency_count; ++i)
+    {
+      std::filesystem::path dependency_file(reader.str());
+      if (dependency_file.is_relative())
+      {
+        dependency_file = (std::filesystem::path(path).parent_path() / dependency_file).lexically_normal();
+      }
+      iface.dependencies.push_back({dependency_file.string(), reader.u64()});
+    }
+
+    // map interface-local type indices back to specs in this compilation's arena
+    Location type_loc(1, 1, source_file);
+    std::vector<TySpecId> types;
+    auto type_ref = [&](uint32_t index)
+    {
+      if (index >= types.size())
+        reader.fail("type index out of range");
+      return types[index];
+    };
+
+    uint32_t type_count = reader.u32();
+    types.reserve(type_count);
+    for (uint32_t i = 0; i < type_count; ++i)
+    {
+      switch (static_cast<TySpec::Kind>(reader.u8()))
+      {
+      case TySpec::Kind::Builtin:
+        types.push_back(type_arena.builtin(type_loc, static_cast<TySpec::Builtin>(reader.u8())));
+        break;
+      case TySpec::Kind::Named:
+        types.push_back(type_arena.named(type_loc, reader.str()));
+        break;
+      case TySpec::Kind::Array:
+      {
+        TySpecId element = type_ref(reader.u32());
+        bool has_size = reader.u8() != 0;
+        uint64_t size = reader.u64();
+        types.push_back(type_arena.array(type_loc, element,
+                                         has_size ? std::optional<uint64_t>(size) : std::nullopt));
+        break;
+      }
+      case TySpec::Kind::Ref:
+        types.push_back(type_arena.ref(type_loc, type_ref(reader.u32())));
+        break;
+      default:
+        reader.fail("unknown type kind");
+      }
+    }
+
+    uint32_t decl_count = reader.u32();
+    for (uint32_t i = 0; i < decl_count; ++i)
+    {
+      auto tag = static_cast<DeclTag>(reader.u8());
+      bool is_public = reader.u8() != 0;
+      uint32_t line = reader.u32();
+      uint32_t col = reader.u32();
+      Location loc(line, col, source_file);
+      std::string name = reader.str();
+
+      switch (tag)
+      {
+      case DeclTag::Struct:
+      {
+        std::vector<ast::StructField> fields;
+        uint32_t field_count = reader.u32();
+        for (uint32_t f = 0; f < field_count; ++f)
+        {
+          std::string field_name = reader.str();
+          fields.emplace_back(loc, std::move(field_name), type_ref(reader.u32()));
+        }
+        iface.program->m_nodes.push_back(
+            std::make_unique<ast::StructDecl>(loc, name, std::move(fields), is_public));
+        break;
+      }
+      case DeclTag::Enum:
+      {
+        std::vector<std::string> variants;
+        uint32_t variant_count = reader.u32();
+        for (uint32_t v = 0; v < variant_count; ++v)
+          variants.push_back(reader.str());
+        iface.program->m_nodes.push_back(
+            std::make_unique<ast::EnumDecl>(loc, name, std::move(variants), is_public));
+        break;
+      }
+      case DeclTag::ExternType:
+        iface.program->m_nodes.push_back(
+            std::make_unique<ast::ExternTypeDecl>(loc, name, is_public));
+        break;
+      case DeclTag::Function:
+      {
+        bool is_foreign = reader.u8() != 0; // extern in the source module; always extern from here
+        TySpecId return_type = type_ref(reader.u32());
+        std::vector<ast::Parameter> params;
+        uint32_t param_count = reader.u32();
+        for (uint32_t p = 0; p < param_count; ++p)
+        {
+          std::string param_name = reader.str();
+          params.emplace_back(loc, std::move(param_name), type_ref(reader.u32()));
+        }
+        auto func = std::make_unique<ast::Function>(
+            loc, std::make_unique<ast::Identifier>(loc, name), std::move(params),
+            return_type, nullptr, true, is_public);
+        func->m_is_foreign = is_foreign;
+        uint8_t attribute_count = reader.u8();
+        for (uint8_t a = 0; a < attribute_count; ++a)
+        {
+          uint8_t attribute = reader.u8();
+          if (attribute > static_cast<uint8_t>(ast::FunctionAttribute::Pure))
+            reader.fail("unknown function attribute");
+          func->m_attributes.push_back(static_cast<ast::FunctionAttribute>(attribute));
+        }
+        iface.program->m_nodes.push_back(std::move(func));
+        break;
+      }
+      default:
+        reader.fail("unknown declaration kind");
+      }
+    }
+
+    return iface;
+  }
+
+  uint64_t hash_source_file(const std::string &path)
+  {
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+    {
+      return 0;
+    }
+
+    uint64_t hash = FNV_OFFSET;
+    for (std::istreambuf_iterator<char> it(file), end; it != end; ++it)
+    {
+      hash = (hash ^ static_cast<unsigned char>(*it)) * FNV_PRIME;
+    }
+    return hash;
+  }
+
+  const InterfaceDependency *changed_dependency(const ModuleInterface &iface)
+  {
+    for (const auto &dependency : iface.dependencies)
+    {
+      if (hash_source_file(dependency.source_file) != dependency.content_hash)
+      {
+        return &dependency;
+      }
+    }
+    return nullptr;
+  }
+
+  std::string module_cache_stem(const std::string &source_file)
+  {
+    std::ostringstream stem;
+    stem << std::filesystem::path(source_file).stem().string() << '-' << std::hex
+         << std::setw(16) << std::setfill('0') << std::hash<std::string>{}(source_file);
+    return stem.str();
+  }
+
+} // namespace aloha
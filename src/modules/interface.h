@@ -0,0 +1,70 @@
+#ifndef MODULES_INTERFACE_H_
+#define MODULES_INTERFACE_H_
+
+#include "../ast/ast.h"
+#include "../ast/ty_spec.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace aloha
+{
+  // Compiled module interfaces (.aloi) describe the public surface of a
+  // separately compiled module: its imports, struct/enum/extern type
+  // declarations and public function signatures with their attributes, plus
+  // the object file that holds the definitions and the sources it was
+  // compiled against. Type specs are stored once in
+  // a type table and referenced by index from the declarations.
+
+  inline constexpr const char *INTERFACE_EXTENSION = ".aloi";
+  // the module's LLVM bitcode, written next to the interface so that -O can
+  // inline across modules; optional
+  inline constexpr const char *BITCODE_EXTENSION = ".bc";
+  inline constexpr uint32_t INTERFACE_VERSION = 3;
+
+  // an imported source the module was compiled against; the module's object
+  // only fits while its contents are unchanged
+  struct InterfaceDependency
+  {
+    std::string source_file; // resolved against the interface's directory if stored relative
+    uint64_t content_hash;   // see hash_source_file
+  };
+
+  struct ModuleInterface
+  {
+    std::string source_file; // as recorded when the interface was written
+    std::string object_file; // resolved against the interface's directory if stored relative
+    std::vector<InterfaceDependency> dependencies;
+
+    // declaration-only program: imports, type declarations and extern
+    // functions standing in for the module's public functions
+    std::unique_ptr<ast::Program> program;
+  };
+
+  // throws std::runtime_error on I/O failure
+  void write_module_interface(const std::string &path, const ast::Program &program,
+                              const TySpecArena &type_arena,
+                              const std::string &source_file,
+                              const std::string &object_file,
+                              const std::vector<InterfaceDependency> &dependencies);
+
+  // throws std::runtime_error if the file is missing, truncated or of a
+  // different version
+  ModuleInterface read_module_interface(const std::string &path, const std::string &source_file,
+                                        TySpecArena &type_arena);
+
+  // 64-bit FNV-1a of the file's bytes, so it is the same for every build of
+  // the compiler; 0 if the file cannot be read
+  uint64_t hash_source_file(const std::string &path);
+
+  // the first dependency of iface whose contents changed since the interface
+  // was written, or nullptr while all of them are current
+  const InterfaceDependency *changed_dependency(const ModuleInterface &iface);
+
+  // name, without extension, under which a module cache keeps the interface,
+  // object and bitcode of source_file; distinct for every source path
+  std::string module_cache_stem(const std::string &source_file);
+
+} // namespace aloha
+
+#endif // MODULES_INTERFACE_H_
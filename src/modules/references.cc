@@ -0,0 +1,231 @@
+#include "references.h"
+
+namespace aloha
+{
+  namespace
+  {
+    class ReferenceCollector
+    {
+    public:
+      ReferenceCollector(const TySpecArena &type_arena, std::unordered_set<std::string> &names)
+          : type_arena(type_arena), names(names) {}
+
+      void type(TySpecId id)
+      {
+        const TySpec &spec = type_arena[id];
+        switch (spec.kind)
+        {
+        case TySpec::Kind::Named:
+          names.insert(spec.name);
+          break;
+        case TySpec::Kind::Array:
+        case TySpec::Kind::Ref:
+          type(spec.element);
+          break;
+        case TySpec::Kind::Builtin:
+          break;
+        }
+      }
+
+      void path(const ast::QualifiedPath &qualified)
+      {
+        for (const auto &segment : qualified.m_segments)
+          names.insert(segment);
+      }
+
+      void field_values(const std::vector<ast::StructInstantiation::FieldValue> &values)
+      {
+        for (const auto &value : values)
+          expression(value.m_value.get());
+      }
+
+      void expression(ast::Expression *expr)
+      {
+        if (!expr)
+          return;
+
+        if (auto unary = dynamic_cast<ast::UnaryExpression *>(expr))
+        {
+          expression(unary->m_expr.get());
+        }
+        else if (auto binary = dynamic_cast<ast::BinaryExpression *>(expr))
+        {
+          expression(binary->m_left.get());
+          expression(binary->m_right.get());
+        }
+        else if (auto variant = dynamic_cast<ast::EnumVariant *>(expr))
+        {
+          path(variant->m_path);
+        }
+        else if (auto match = dynamic_cast<ast::MatchExpression *>(expr))
+        {
+          expression(match->m_scrutinee.get());
+          for (auto &arm : match->m_arms)
+          {
+            if (arm.m_pattern)
+              path(*arm.m_pattern);
+            expression(arm.m_value.get());
+          }
+        }
+        else if (auto access = dynamic_cast<ast::StructFieldAccess *>(expr))
+        {
+          expression(access->m_struct_expr.get());
+        }
+        else if (auto call = dynamic_cast<ast::FunctionCall *>(expr))
+        {
+          path(call->m_path);
+          for (auto &arg : call->m_arguments)
+            expression(arg.get());
+        }
+        else if (auto inst = dynamic_cast<ast::StructInstantiation *>(expr))
+        {
+          names.insert(inst->m_struct_name);
+          field_values(inst->m_field_values);
+        }
+        else if (auto new_obj = dynamic_cast<ast::NewObjectExpression *>(expr))
+        {
+          names.insert(new_obj->m_struct_name);
+          expression(new_obj->m_arena.get());
+          field_values(new_obj->m_field_values);
+        }
+        else if (auto array = dynamic_cast<ast::Array *>(expr))
+        {
+          for (auto &member : array->m_members)
+            expression(member.get());
+        }
+        else if (auto array_access = dynamic_cast<ast::ArrayAccess *>(expr))
+        {
+          expression(array_access->m_array_expr.get());
+          expression(array_access->m_index_expr.get());
+        }
+      }
+
+      void statement(ast::Statement *stmt)
+      {
+        if (!stmt)
+          return;
+
+        if (auto block = dynamic_cast<ast::StatementBlock *>(stmt))
+        {
+          for (auto &inner : block->m_statements)
+            statement(inner.get());
+        }
+        else if (auto expr_stmt = dynamic_cast<ast::ExpressionStatement *>(stmt))
+        {
+          expression(expr_stmt->m_expr.get());
+        }
+        else if (auto decl = dynamic_cast<ast::Declaration *>(stmt))
+        {
+          if (decl->m_type)
+            type(*decl->m_type);
+          expression(decl->m_expression.get());
+        }
+        else if (auto assign = dynamic_cast<ast::Assignment *>(stmt))
+        {
+          expression(assign->m_expression.get());
+        }
+        else if (auto array_assign = dynamic_cast<ast::ArrayAssignment *>(stmt))
+        {
+          expression(array_assign->m_index_expr.get());
+          expression(array_assign->m_value.get());
+        }
+        else if (auto field_assign = dynamic_cast<ast::StructFieldAssignment *>(stmt))
+        {
+          expression(field_assign->m_struct_expr.get());
+          expression(field_assign->m_value.get());
+        }
+        else if (auto ret = dynamic_cast<ast::ReturnStatement *>(stmt))
+        {
+          expression(ret->m_expression.get());
+        }
+        else if (auto if_stmt = dynamic_cast<ast::IfStatement *>(stmt))
+        {
+          expression(if_stmt->m_condition.get());
+          statement(if_stmt->m_then_branch.get());
+          statement(if_stmt->m_else_branch.get());
+        }
+        else if (auto match = dynamic_cast<ast::MatchStatement *>(stmt))
+        {
+          expression(match->m_scrutinee.get());
+          for (auto &arm : match->m_arms)
+          {
+            if (arm.m_pattern)
+              path(*arm.m_pattern);
+            statement(arm.m_body.get());
+          }
+        }
+        else if (auto while_loop = dynamic_cast<ast::WhileLoop *>(stmt))
+        {
+          expression(while_loop->m_condition.get());
+          statement(while_loop->m_body.get());
+        }
+        else if (auto for_loop = dynamic_cast<ast::ForLoop *>(stmt))
+        {
+          statement(for_loop->m_initializer.get());
+          expression(for_loop->m_condition.get());
+          statement(for_loop->m_increment.get());
+          statement(for_loop->m_body.get());
+        }
+        else if (auto func = dynamic_cast<ast::Function *>(stmt))
+        {
+          for (const auto &param : func->m_parameters)
+            type(param.m_type);
+          type(func->m_return_type);
+          statement(func->m_body.get());
+        }
+        else if (auto struct_decl = dynamic_cast<ast::StructDecl *>(stmt))
+        {
+          for (const auto &field : struct_decl->m_fields)
+            type(field.m_type);
+        }
+      }
+
+    private:
+      const TySpecArena &type_arena;
+      std::unordered_set<std::string> &names;
+    };
+  } // namespace
+
+  std::unordered_set<std::string> collect_referenced_names(const ast::Program &program,
+                                                           const TySpecArena &type_arena)
+  {
+    std::unordered_set<std::string> names;
+    ReferenceCollector collector(type_arena, names);
+    for (const auto &node : program.m_nodes)
+    {
+      if (auto stmt = dynamic_cast<ast::Statement *>(node.get()))
+        collector.statement(stmt);
+    }
+    return names;
+  }
+
+  std::unordered_set<std::string> collect_public_names(const ast::Program &program)
+  {
+    std::unordered_set<std::string> names;
+    for (const auto &node : program.m_nodes)
+    {
+      if (auto func = dynamic_cast<ast::Function *>(node.get()))
+      {
+        if (func->m_is_public)
+          names.insert(func->m_name->m_name);
+      }
+      else if (auto struct_decl = dynamic_cast<ast::StructDecl *>(node.get()))
+      {
+        if (struct_decl->m_is_public)
+          names.insert(struct_decl->m_name);
+      }
+      else if (auto enum_decl = dynamic_cast<ast::EnumDecl *>(node.get()))
+      {
+        if (enum_decl->m_is_public)
+          names.insert(enum_decl->m_name);
+      }
+      else if (auto extern_type = dynamic_cast<ast::ExternTypeDecl *>(node.get()))
+      {
+        if (extern_type->m_is_public)
+          names.insert(extern_type->m_name);
+      }
+    }
+    return names;
+  }
+
+} // namespace aloha
@@ -0,0 +1,23 @@
+#ifndef MODULES_REFERENCES_H_
+#define MODULES_REFERENCES_H_
+
+#include "../ast/ast.h"
+#include "../ast/ty_spec.h"
+#include <string>
+#include <unordered_set>
+
+namespace aloha
+{
+  // Collects every name a program may resolve against another module:
+  // called functions, named types in signatures and declarations, struct
+  // instantiations and the segments of qualified paths. Local names that
+  // happen to collide are included too; the set only has to be a superset.
+  std::unordered_set<std::string> collect_referenced_names(const ast::Program &program,
+                                                           const TySpecArena &type_arena);
+
+  // Names a module makes visible to its importers
+  std::unordered_set<std::string> collect_public_names(const ast::Program &program);
+
+} // namespace aloha
+
+#endif // MODULES_REFERENCES_H_
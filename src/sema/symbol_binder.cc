@@ -330,9 +330,9 @@ namespace aloha
         bind_statement(for_loop->m_initializer.get(), &loop_scope);
       }
 
-      for (const auto &body_stmt : for_loop->m_body)
+      if (for_loop->m_body)
       {
-        bind_statement(body_stmt.get(), &loop_scope);
+        bind_statement_block(for_loop->m_body.get(), &loop_scope);
       }
     }
   }
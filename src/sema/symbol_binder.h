@@ -34,6 +34,10 @@ namespace aloha
 
     bool bind(ast::Program *program, TySpecArena &type_arena);
 
+    // bind the variables of one function body against declarations that are
+    // already in the symbol table, e.g. after only that body was edited
+    void bind_function_body(ast::Function *func);
+
     SymbolTable &get_symbol_table() { return *symbol_table_ptr; }
     const SymbolTable &get_symbol_table() const { return *symbol_table_ptr; }
 
@@ -53,7 +57,6 @@ namespace aloha
 
     // bind variables in function bodies
     void bind_function_bodies(ast::Program *program);
-    void bind_function_body(ast::Function *func);
     void bind_statement(ast::Statement *stmt, Scope *scope);
     void bind_statement_block(ast::StatementBlock *block, Scope *parent_scope);
 
@@ -44,12 +44,7 @@ namespace aloha
             return "";
         }
 
-        std::string get_stdlib_archive()
-        {
-            return get_stdlib_paths().library_file.string();
-        }
-
-        StdlibPaths get_stdlib_paths()
+        static StdlibPaths find_stdlib_library()
         {
             StdlibPaths paths;
             paths.root = get_aloha_root();
@@ -95,5 +90,17 @@ namespace aloha
             return paths;
         }
 
+        StdlibPaths get_stdlib_paths()
+        {
+            StdlibPaths paths = find_stdlib_library();
+            paths.interface_dir = paths.library_file.parent_path() / "stdlib";
+            return paths;
+        }
+
+        std::string get_stdlib_archive()
+        {
+            return get_stdlib_paths().library_file.string();
+        }
+
     } // namespace utils
 } // namespace aloha
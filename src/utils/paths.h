@@ -13,6 +13,8 @@ namespace aloha
             std::filesystem::path root;
             std::filesystem::path source_dir;
             std::filesystem::path library_file;
+            // prebuilt stdlib module interfaces, next to the runtime archive
+            std::filesystem::path interface_dir;
         };
 
         std::filesystem::path get_aloha_root();
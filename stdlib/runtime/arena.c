@@ -2,55 +2,69 @@
 
 #include <stdlib.h>
 
-static size_t aloha_align_up(size_t value, size_t alignment)
-{
-    return (value + alignment - 1) & ~(alignment - 1);
-}
+#define ALOHA_ARENA_MIN_BLOCK 4096
+#define ALOHA_ARENA_MAX_BLOCK (1024 * 1024)
 
-static aloha_arena_block *aloha_arena_new_block(size_t capacity)
+static aloha_arena_block *aloha_arena_new_block(aloha_arena_block **chain, size_t capacity)
 {
     aloha_arena_block *block = (aloha_arena_block *)malloc(sizeof(aloha_arena_block) + capacity);
     if (!block)
         return NULL;
-    block->next = NULL;
+    block->next = *chain;
     block->capacity = capacity;
-    block->used = 0;
+    *chain = block;
     return block;
 }
 
+static void aloha_arena_free_chain(aloha_arena_block *block)
+{
+    while (block)
+    {
+        aloha_arena_block *next = block->next;
+        free(block);
+        block = next;
+    }
+}
+
 void *aloha_arena_new(void)
 {
     aloha_arena *arena = (aloha_arena *)malloc(sizeof(aloha_arena));
     if (!arena)
         return NULL;
+    arena->cursor = NULL;
+    arena->limit = NULL;
     arena->blocks = NULL;
+    arena->large_blocks = NULL;
+    arena->next_capacity = ALOHA_ARENA_MIN_BLOCK;
     return arena;
 }
 
-void *aloha_arena_alloc(void *arena_ptr, aloha_int size)
+// size is a multiple of 8 that does not fit in the current block
+void *aloha_arena_alloc_slow(aloha_arena *arena, size_t size)
 {
-    if (!arena_ptr || size <= 0)
-        return NULL;
-
-    aloha_arena *arena = (aloha_arena *)arena_ptr;
-    size_t requested = aloha_align_up((size_t)size, 8);
-    size_t default_capacity = 4096;
-    size_t capacity = requested > default_capacity ? requested : default_capacity;
-
-    aloha_arena_block *block = arena->blocks;
-    if (!block || block->used + requested > block->capacity)
+    // a quarter of a block or more would waste too much of the current one
+    if (size > arena->next_capacity / 4)
     {
-        aloha_arena_block *new_block = aloha_arena_new_block(capacity);
-        if (!new_block)
-            return NULL;
-        new_block->next = arena->blocks;
-        arena->blocks = new_block;
-        block = new_block;
+        aloha_arena_block *block = aloha_arena_new_block(&arena->large_blocks, size);
+        return block ? block->data : NULL;
     }
 
-    void *ptr = block->data + block->used;
-    block->used += requested;
-    return ptr;
+    aloha_arena_block *block = aloha_arena_new_block(&arena->blocks, arena->next_capacity);
+    if (!block)
+        return NULL;
+    if (arena->next_capacity < ALOHA_ARENA_MAX_BLOCK)
+        arena->next_capacity *= 2;
+
+    arena->cursor = block->data + size;
+    arena->limit = block->data + block->capacity;
+    return block->data;
+}
+
+void *aloha_arena_alloc(void *arena_ptr, aloha_int size)
+{
+    if (!arena_ptr || size <= 0)
+        return NULL;
+    return aloha_arena_bump((aloha_arena *)arena_ptr, (size_t)size);
 }
 
 void aloha_arena_free_all(void *arena_ptr)
@@ -59,12 +73,7 @@ void aloha_arena_free_all(void *arena_ptr)
         return;
 
     aloha_arena *arena = (aloha_arena *)arena_ptr;
-    aloha_arena_block *block = arena->blocks;
-    while (block)
-    {
-        aloha_arena_block *next = block->next;
-        free(block);
-        block = next;
-    }
+    aloha_arena_free_chain(arena->blocks);
+    aloha_arena_free_chain(arena->large_blocks);
     free(arena);
 }
@@ -0,0 +1,129 @@
+#include "runtime.h"
+
+#include <string.h>
+
+#define ALOHA_BUILDER_INITIAL_CAPACITY 64
+
+// Appends into one arena buffer that doubles when full, so building a
+// string from k pieces copies each byte O(1) times on average. The buffer
+// keeps room for the length in front and the terminator at the end, which
+// lets finish hand out the bytes in place; the builder then starts over
+// with a new buffer, since the finished string must not change.
+typedef struct aloha_string_builder
+{
+    aloha_arena *arena;
+    char *data; // after the room for the header
+    size_t len;
+    size_t cap; // bytes available for data, not counting the terminator
+} aloha_string_builder;
+
+void *aloha_string_builder_new(void *arena_ptr)
+{
+    if (!arena_ptr)
+        return NULL;
+
+    aloha_string_builder *builder = aloha_arena_alloc(arena_ptr, sizeof(aloha_string_builder));
+    if (!builder)
+        return NULL;
+
+    builder->arena = (aloha_arena *)arena_ptr;
+    builder->data = NULL;
+    builder->len = 0;
+    builder->cap = 0;
+    return builder;
+}
+
+// makes room for extra more bytes; returns where they go
+static char *aloha_string_builder_reserve(aloha_string_builder *builder, size_t extra)
+{
+    if (builder->len + extra <= builder->cap)
+        return builder->data + builder->len;
+
+    size_t cap = builder->cap ? builder->cap * 2 : ALOHA_BUILDER_INITIAL_CAPACITY;
+    while (cap < builder->len + extra)
+        cap *= 2;
+
+    char *data = aloha_string_alloc(builder->arena, (aloha_int)cap);
+    if (!data)
+        return NULL;
+    if (builder->len)
+        memcpy(data, builder->data, builder->len);
+
+    builder->data = data;
+    builder->cap = cap;
+    return data + builder->len;
+}
+
+void aloha_string_builder_append(void *builder_ptr, const char *str)
+{
+    if (!builder_ptr || !str)
+        return;
+
+    aloha_string_builder *builder = (aloha_string_builder *)builder_ptr;
+    size_t len = (size_t)aloha_string_length(str);
+    char *out = aloha_string_builder_reserve(builder, len);
+    if (!out)
+        return;
+    memcpy(out, str, len);
+    builder->len += len;
+}
+
+void aloha_string_builder_append_int(void *builder_ptr, aloha_int value)
+{
+    if (!builder_ptr)
+        return;
+
+    aloha_string_builder *builder = (aloha_string_builder *)builder_ptr;
+    char *out = aloha_string_builder_reserve(builder, ALOHA_INT_FORMAT_SIZE);
+    if (out)
+        builder->len += aloha_format_int(out, value);
+}
+
+void aloha_string_builder_append_float(void *builder_ptr, aloha_float value)
+{
+    if (!builder_ptr)
+        return;
+
+    aloha_string_builder *builder = (aloha_string_builder *)builder_ptr;
+    char *out = aloha_string_builder_reserve(builder, ALOHA_FLOAT_FORMAT_SIZE);
+    if (out)
+        builder->len += aloha_format_float(out, value);
+}
+
+// appends the byte with the given code, as returned by string_char_at
+void aloha_string_builder_append_char(void *builder_ptr, aloha_int code)
+{
+    if (!builder_ptr)
+        return;
+
+    aloha_string_builder *builder = (aloha_string_builder *)builder_ptr;
+    char *out = aloha_string_builder_reserve(builder, 1);
+    if (!out)
+        return;
+    *out = (char)code;
+    builder->len++;
+}
+
+aloha_int aloha_string_builder_len(void *builder_ptr)
+{
+    return builder_ptr ? (aloha_int)((aloha_string_builder *)builder_ptr)->len : 0;
+}
+
+char *aloha_string_builder_finish(void *builder_ptr)
+{
+    if (!builder_ptr)
+        return NULL;
+
+    aloha_string_builder *builder = (aloha_string_builder *)builder_ptr;
+    if (!builder->data)
+        return aloha_string_alloc(builder->arena, 0);
+
+    char *result = builder->data;
+    result[builder->len] = '\0';
+    aloha_string_set_length(result, (aloha_int)builder->len);
+
+    builder->data = NULL;
+    builder->len = 0;
+    builder->cap = 0;
+    return result;
+}
@@ -0,0 +1,98 @@
+#include "runtime.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Read-only file mappings. The file is mapped right after one page of
+// anonymous memory that holds the mapping's bookkeeping and, in its last
+// bytes, the string header, so the contents are an ordinary string without
+// copying. The zeroes the kernel puts past the end of the file, or the
+// anonymous page reserved after it, terminate the string.
+typedef struct aloha_mapped_file
+{
+    char *region;
+    size_t region_size;
+    char *contents;
+} aloha_mapped_file;
+
+aloha_int aloha_file_open(const char *path)
+{
+    if (!path)
+        return -1;
+
+    int fd;
+    do
+    {
+        fd = open(path, O_RDONLY | O_CLOEXEC);
+    } while (fd < 0 && errno == EINTR);
+    return fd;
+}
+
+void aloha_file_close(aloha_int fd)
+{
+    if (fd >= 0)
+        close((int)fd);
+}
+
+void *aloha_file_map(aloha_int fd)
+{
+    struct stat st;
+    if (fstat((int)fd, &st) != 0 || !S_ISREG(st.st_mode) || (uint64_t)st.st_size > INT64_MAX / 2)
+        return NULL;
+
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t size = (size_t)st.st_size;
+    size_t mapped = (size + page - 1) & ~(page - 1);
+    // header page, the file, and a zero page when it fills its last page
+    size_t region_size = page + mapped + page;
+
+    char *region = mmap(NULL, region_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (region == MAP_FAILED)
+        return NULL;
+
+    char *contents = region + page;
+    if (size > 0)
+    {
+        if (mmap(contents, size, PROT_READ, MAP_PRIVATE | MAP_FIXED, (int)fd, 0) == MAP_FAILED)
+        {
+            munmap(region, region_size);
+            return NULL;
+        }
+        madvise(contents, mapped, MADV_SEQUENTIAL);
+    }
+
+    aloha_mapped_file *file = (aloha_mapped_file *)region;
+    file->region = region;
+    file->region_size = region_size;
+    file->contents = contents;
+    aloha_string_set_length(contents, (aloha_int)size);
+    // the view is read-only all the way through
+    mprotect(region, page, PROT_READ);
+    mprotect(contents + mapped, page, PROT_READ);
+    return file;
+}
+
+bool aloha_mapped_file_ok(void *file_ptr)
+{
+    return file_ptr != NULL;
+}
+
+char *aloha_mapped_file_contents(void *file_ptr)
+{
+    if (!file_ptr)
+        return NULL;
+    return ((aloha_mapped_file *)file_ptr)->contents;
+}
+
+void aloha_file_unmap(void *file_ptr)
+{
+    if (!file_ptr)
+        return;
+
+    aloha_mapped_file *file = (aloha_mapped_file *)file_ptr;
+    munmap(file->region, file->region_size);
+}
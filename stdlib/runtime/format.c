@@ -0,0 +1,376 @@
+#include "runtime.h"
+
+#include <math.h>
+#include <string.h>
+
+// Number formatting for the print paths and string conversions. Integers
+// are written two digits at a time; floats use Grisu2, which yields the
+// shortest or nearly shortest digits that read back to the same double.
+
+static const char aloha_digit_pairs[] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static size_t aloha_format_uint(char *out, uint64_t value)
+{
+    char buf[20];
+    char *end = buf + sizeof(buf);
+    char *p = end;
+    while (value >= 100)
+    {
+        unsigned pair = (unsigned)(value % 100) * 2;
+        value /= 100;
+        *--p = aloha_digit_pairs[pair + 1];
+        *--p = aloha_digit_pairs[pair];
+    }
+    if (value >= 10)
+    {
+        unsigned pair = (unsigned)value * 2;
+        *--p = aloha_digit_pairs[pair + 1];
+        *--p = aloha_digit_pairs[pair];
+    }
+    else
+    {
+        *--p = (char)('0' + value);
+    }
+
+    size_t len = (size_t)(end - p);
+    memcpy(out, p, len);
+    return len;
+}
+
+size_t aloha_format_int(char *out, aloha_int value)
+{
+    if (value >= 0)
+        return aloha_format_uint(out, (uint64_t)value);
+
+    // negate in unsigned arithmetic so INT64_MIN does not overflow
+    out[0] = '-';
+    return 1 + aloha_format_uint(out + 1, 0 - (uint64_t)value);
+}
+
+// an unnormalized binary floating point number f * 2^e
+typedef struct aloha_diy_fp
+{
+    uint64_t f;
+    int e;
+} aloha_diy_fp;
+
+#define ALOHA_DP_SIGNIFICAND_MASK 0x000FFFFFFFFFFFFFULL
+#define ALOHA_DP_HIDDEN_BIT 0x0010000000000000ULL
+#define ALOHA_DP_EXPONENT_BIAS 1075 // 0x3FF + 52
+#define ALOHA_DP_MIN_EXPONENT (-ALOHA_DP_EXPONENT_BIAS + 1)
+
+// 10^k for k = -348, -340, ..., 340, normalized and rounded to nearest
+static const uint64_t aloha_cached_powers_f[] = {
+    0xfa8fd5a0081c0288ULL, 0xbaaee17fa23ebf76ULL, 0x8b16fb203055ac76ULL,
+    0xcf42894a5dce35eaULL, 0x9a6bb0aa55653b2dULL, 0xe61acf033d1a45dfULL,
+    0xab70fe17c79ac6caULL, 0xff77b1fcbebcdc4fULL, 0xbe5691ef416bd60cULL,
+    0x8dd01fad907ffc3cULL, 0xd3515c2831559a83ULL, 0x9d71ac8fada6c9b5ULL,
+    0xea9c227723ee8bcbULL, 0xaecc49914078536dULL, 0x823c12795db6ce57ULL,
+    0xc21094364dfb5637ULL, 0x9096ea6f3848984fULL, 0xd77485cb25823ac7ULL,
+    0xa086cfcd97bf97f4ULL, 0xef340a98172aace5ULL, 0xb23867fb2a35b28eULL,
+    0x84c8d4dfd2c63f3bULL, 0xc5dd44271ad3cdbaULL, 0x936b9fcebb25c996ULL,
+    0xdbac6c247d62a584ULL, 0xa3ab66580d5fdaf6ULL, 0xf3e2f893dec3f126ULL,
+    0xb5b5ada8aaff80b8ULL, 0x87625f056c7c4a8bULL, 0xc9bcff6034c13053ULL,
+    0x964e858c91ba2655ULL, 0xdff9772470297ebdULL, 0xa6dfbd9fb8e5b88fULL,
+    0xf8a95fcf88747d94ULL, 0xb94470938fa89bcfULL, 0x8a08f0f8bf0f156bULL,
+    0xcdb02555653131b6ULL, 0x993fe2c6d07b7facULL, 0xe45c10c42a2b3b06ULL,
+    0xaa242499697392d3ULL, 0xfd87b5f28300ca0eULL, 0xbce5086492111aebULL,
+    0x8cbccc096f5088ccULL, 0xd1b71758e219652cULL, 0x9c40000000000000ULL,
+    0xe8d4a51000000000ULL, 0xad78ebc5ac620000ULL, 0x813f3978f8940984ULL,
+    0xc097ce7bc90715b3ULL, 0x8f7e32ce7bea5c70ULL, 0xd5d238a4abe98068ULL,
+    0x9f4f2726179a2245ULL, 0xed63a231d4c4fb27ULL, 0xb0de65388cc8ada8ULL,
+    0x83c7088e1aab65dbULL, 0xc45d1df942711d9aULL, 0x924d692ca61be758ULL,
+    0xda01ee641a708deaULL, 0xa26da3999aef774aULL, 0xf209787bb47d6b85ULL,
+    0xb454e4a179dd1877ULL, 0x865b86925b9bc5c2ULL, 0xc83553c5c8965d3dULL,
+    0x952ab45cfa97a0b3ULL, 0xde469fbd99a05fe3ULL, 0xa59bc234db398c25ULL,
+    0xf6c69a72a3989f5cULL, 0xb7dcbf5354e9beceULL, 0x88fcf317f22241e2ULL,
+    0xcc20ce9bd35c78a5ULL, 0x98165af37b2153dfULL, 0xe2a0b5dc971f303aULL,
+    0xa8d9d1535ce3b396ULL, 0xfb9b7cd9a4a7443cULL, 0xbb764c4ca7a44410ULL,
+    0x8bab8eefb6409c1aULL, 0xd01fef10a657842cULL, 0x9b10a4e5e9913129ULL,
+    0xe7109bfba19c0c9dULL, 0xac2820d9623bf429ULL, 0x80444b5e7aa7cf85ULL,
+    0xbf21e44003acdd2dULL, 0x8e679c2f5e44ff8fULL, 0xd433179d9c8cb841ULL,
+    0x9e19db92b4e31ba9ULL, 0xeb96bf6ebadf77d9ULL, 0xaf87023b9bf0ee6bULL,
+};
+
+static const int16_t aloha_cached_powers_e[] = {
+    -1220, -1193, -1166, -1140, -1113, -1087, -1060, -1034, -1007, -980,
+    -954, -927, -901, -874, -847, -821, -794, -768, -741, -715,
+    -688, -661, -635, -608, -582, -555, -529, -502, -475, -449,
+    -422, -396, -369, -343, -316, -289, -263, -236, -210, -183,
+    -157, -130, -103, -77, -50, -24, 3, 30, 56, 83,
+    109, 136, 162, 189, 216, 242, 269, 295, 322, 348,
+    375, 402, 428, 455, 481, 508, 534, 561, 588, 614,
+    641, 667, 694, 720, 747, 774, 800, 827, 853, 880,
+    907, 933, 960, 986, 1013, 1039, 1066,
+};
+
+static const uint64_t aloha_pow10[] = {
+    1ULL, 10ULL, 100ULL, 1000ULL, 10000ULL, 100000ULL, 1000000ULL, 10000000ULL,
+    100000000ULL, 1000000000ULL, 10000000000ULL, 100000000000ULL, 1000000000000ULL,
+    10000000000000ULL, 100000000000000ULL, 1000000000000000ULL, 10000000000000000ULL,
+    100000000000000000ULL, 1000000000000000000ULL, 10000000000000000000ULL};
+
+static aloha_diy_fp aloha_diy_fp_mul(aloha_diy_fp x, aloha_diy_fp y)
+{
+    const uint64_t mask = 0xFFFFFFFFULL;
+    uint64_t a = x.f >> 32, b = x.f & mask;
+    uint64_t c = y.f >> 32, d = y.f & mask;
+    uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+    uint64_t tmp = (bd >> 32) + (ad & mask) + (bc & mask);
+    tmp += 1ULL << 31; // round
+    aloha_diy_fp result = {ac + (ad >> 32) + (bc >> 32) + (tmp >> 32), x.e + y.e + 64};
+    return result;
+}
+
+static aloha_diy_fp aloha_diy_fp_normalize(aloha_diy_fp x)
+{
+    int shift = __builtin_clzll(x.f);
+    aloha_diy_fp result = {x.f << shift, x.e - shift};
+    return result;
+}
+
+// the points halfway to the neighbouring doubles, with a shared exponent
+static void aloha_normalized_boundaries(aloha_diy_fp v, aloha_diy_fp *minus, aloha_diy_fp *plus)
+{
+    aloha_diy_fp pl = {(v.f << 1) + 1, v.e - 1};
+    pl = aloha_diy_fp_normalize(pl);
+
+    // the gap below a power of two is half as wide
+    aloha_diy_fp mi;
+    if (v.f == ALOHA_DP_HIDDEN_BIT)
+    {
+        mi.f = (v.f << 2) - 1;
+        mi.e = v.e - 2;
+    }
+    else
+    {
+        mi.f = (v.f << 1) - 1;
+        mi.e = v.e - 1;
+    }
+    mi.f <<= mi.e - pl.e;
+    mi.e = pl.e;
+
+    *minus = mi;
+    *plus = pl;
+}
+
+// a power of ten c = 10^-k that brings e into [-60, -32]
+static aloha_diy_fp aloha_cached_power(int e, int *k)
+{
+    // ceil((-61 - e) * log10(2)), kept positive so truncation rounds down
+    double dk = (-61 - e) * 0.30102999566398114 + 347;
+    int ik = (int)dk;
+    if (dk - ik > 0.0)
+        ik++;
+
+    unsigned index = (unsigned)((ik >> 3) + 1);
+    *k = -(-348 + (int)(index << 3));
+    aloha_diy_fp result = {aloha_cached_powers_f[index], aloha_cached_powers_e[index]};
+    return result;
+}
+
+static void aloha_grisu_round(char *buffer, int len, uint64_t delta, uint64_t rest,
+                              uint64_t ten_kappa, uint64_t wp_w)
+{
+    // move the last digit towards the exact value while staying in range
+    while (rest < wp_w && delta - rest >= ten_kappa &&
+           (rest + ten_kappa < wp_w || wp_w - rest > rest + ten_kappa - wp_w))
+    {
+        buffer[len - 1]--;
+        rest += ten_kappa;
+    }
+}
+
+static int aloha_count_digits32(uint32_t n)
+{
+    int count = 1;
+    while (count < 10 && n >= aloha_pow10[count])
+        count++;
+    return count;
+}
+
+static void aloha_digit_gen(aloha_diy_fp w, aloha_diy_fp mp, uint64_t delta, char *buffer, int *len, int *k)
+{
+    aloha_diy_fp one = {1ULL << -mp.e, mp.e};
+    uint64_t wp_w = mp.f - w.f;
+    uint32_t p1 = (uint32_t)(mp.f >> -one.e);
+    uint64_t p2 = mp.f & (one.f - 1);
+    int kappa = aloha_count_digits32(p1);
+    *len = 0;
+
+    // digits of the integral part
+    while (kappa > 0)
+    {
+        uint32_t divisor = (uint32_t)aloha_pow10[kappa - 1];
+        uint32_t d = p1 / divisor;
+        p1 %= divisor;
+        if (d || *len)
+            buffer[(*len)++] = (char)('0' + d);
+        kappa--;
+        uint64_t rest = ((uint64_t)p1 << -one.e) + p2;
+        if (rest <= delta)
+        {
+            *k += kappa;
+            aloha_grisu_round(buffer, *len, delta, rest, aloha_pow10[kappa] << -one.e, wp_w);
+            return;
+        }
+    }
+
+    // digits of the fractional part
+    for (;;)
+    {
+        p2 *= 10;
+        delta *= 10;
+        char d = (char)(p2 >> -one.e);
+        if (d || *len)
+            buffer[(*len)++] = (char)('0' + d);
+        p2 &= one.f - 1;
+        kappa--;
+        if (p2 < delta)
+        {
+            *k += kappa;
+            int index = -kappa;
+            aloha_grisu_round(buffer, *len, delta, p2, one.f, wp_w * (index < 20 ? aloha_pow10[index] : 0));
+            return;
+        }
+    }
+}
+
+// digits of a positive finite value, which equals digits * 10^k
+static int aloha_grisu2(double value, char *buffer, int *k)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    int biased_e = (int)((bits >> 52) & 0x7FF);
+    uint64_t significand = bits & ALOHA_DP_SIGNIFICAND_MASK;
+
+    aloha_diy_fp v;
+    if (biased_e != 0)
+    {
+        v.f = significand + ALOHA_DP_HIDDEN_BIT;
+        v.e = biased_e - ALOHA_DP_EXPONENT_BIAS;
+    }
+    else
+    {
+        v.f = significand;
+        v.e = ALOHA_DP_MIN_EXPONENT;
+    }
+
+    aloha_diy_fp w_m, w_p;
+    aloha_normalized_boundaries(v, &w_m, &w_p);
+
+    aloha_diy_fp c_mk = aloha_cached_power(w_p.e, k);
+    aloha_diy_fp w = aloha_diy_fp_mul(aloha_diy_fp_normalize(v), c_mk);
+    aloha_diy_fp wp = aloha_diy_fp_mul(w_p, c_mk);
+    aloha_diy_fp wm = aloha_diy_fp_mul(w_m, c_mk);
+    // stay strictly inside the rounding interval
+    wm.f++;
+    wp.f--;
+
+    int len;
+    aloha_digit_gen(w, wp, wp.f - wm.f, buffer, &len, k);
+    return len;
+}
+
+size_t aloha_format_float(char *out, aloha_float value)
+{
+    if (isnan(value))
+    {
+        memcpy(out, "nan", 3);
+        return 3;
+    }
+
+    char *p = out;
+    if (signbit(value))
+    {
+        *p++ = '-';
+        value = -value;
+    }
+    if (value == 0.0)
+    {
+        *p++ = '0';
+        return (size_t)(p - out);
+    }
+    if (isinf(value))
+    {
+        memcpy(p, "inf", 3);
+        return (size_t)(p - out) + 3;
+    }
+
+    char digits[18];
+    int k;
+    int len = aloha_grisu2(value, digits, &k);
+    // the decimal point goes after this many digits
+    int point = len + k;
+
+    if (len <= point && point <= 21)
+    {
+        // 1234e2 -> 123400
+        memcpy(p, digits, (size_t)len);
+        memset(p + len, '0', (size_t)(point - len));
+        p += point;
+    }
+    else if (0 < point && point <= 21)
+    {
+        // 1234e-2 -> 12.34
+        memcpy(p, digits, (size_t)point);
+        p[point] = '.';
+        memcpy(p + point + 1, digits + point, (size_t)(len - point));
+        p += len + 1;
+    }
+    else if (-6 < point && point <= 0)
+    {
+        // 1234e-6 -> 0.001234
+        p[0] = '0';
+        p[1] = '.';
+        memset(p + 2, '0', (size_t)-point);
+        memcpy(p + 2 - point, digits, (size_t)len);
+        p += 2 - point + len;
+    }
+    else
+    {
+        // 1234e30 -> 1.234e+33
+        *p++ = digits[0];
+        if (len > 1)
+        {
+            *p++ = '.';
+            memcpy(p, digits + 1, (size_t)(len - 1));
+            p += len - 1;
+        }
+        *p++ = 'e';
+        int exponent = point - 1;
+        *p++ = exponent < 0 ? '-' : '+';
+        p += aloha_format_uint(p, (uint64_t)(exponent < 0 ? -exponent : exponent));
+    }
+    return (size_t)(p - out);
+}
+
+char *aloha_string_from_int(void *arena_ptr, aloha_int value)
+{
+    char buf[ALOHA_INT_FORMAT_SIZE];
+    size_t len = aloha_format_int(buf, value);
+    char *result = aloha_string_alloc(arena_ptr, (aloha_int)len);
+    if (result)
+        memcpy(result, buf, len);
+    return result;
+}
+
+char *aloha_string_from_float(void *arena_ptr, aloha_float value)
+{
+    char buf[ALOHA_FLOAT_FORMAT_SIZE];
+    size_t len = aloha_format_float(buf, value);
+    char *result = aloha_string_alloc(arena_ptr, (aloha_int)len);
+    if (result)
+        memcpy(result, buf, len);
+    return result;
+}
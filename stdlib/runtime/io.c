@@ -1,13 +1,143 @@
 #include "runtime.h"
 
-#include <stdio.h>
+#include <errno.h>
 #include <stdlib.h>
+#include <string.h>
 #include <unistd.h>
 
+#define ALOHA_WRITE_BUFFER_SIZE 8192
+
+// Output to stdout and stderr is collected per descriptor and written in
+// large chunks. Terminals still see every line as soon as it is complete;
+// everything else is flushed when a buffer fills, before reading stdin and
+// when the program exits or aborts.
+typedef struct aloha_writer
+{
+    bool initialized;
+    bool line_buffered;
+    size_t used;
+    char data[ALOHA_WRITE_BUFFER_SIZE];
+} aloha_writer;
+
+static aloha_writer aloha_writers[3];
+
+static void aloha_flush_all(void)
+{
+    aloha_sys_flush(1);
+    aloha_sys_flush(2);
+}
+
+static aloha_writer *aloha_writer_for(aloha_int fd)
+{
+    if (fd != 1 && fd != 2)
+        return NULL;
+
+    aloha_writer *writer = &aloha_writers[fd];
+    if (!writer->initialized)
+    {
+        static bool registered = false;
+        if (!registered)
+        {
+            atexit(aloha_flush_all);
+            registered = true;
+        }
+        writer->initialized = true;
+        writer->line_buffered = isatty((int)fd);
+    }
+    return writer;
+}
+
+static bool aloha_write_all(aloha_int fd, const char *buf, size_t count)
+{
+    while (count > 0)
+    {
+        ssize_t written = write((int)fd, buf, count);
+        if (written < 0)
+        {
+            if (errno == EINTR)
+                continue;
+            return false;
+        }
+        buf += written;
+        count -= (size_t)written;
+    }
+    return true;
+}
+
+void aloha_sys_flush(aloha_int fd)
+{
+    if (fd != 1 && fd != 2)
+        return;
+
+    aloha_writer *writer = &aloha_writers[fd];
+    if (writer->used == 0)
+        return;
+    aloha_write_all(fd, writer->data, writer->used);
+    writer->used = 0;
+}
+
+aloha_int aloha_sys_buffered_write(aloha_int fd, const char *buf, aloha_int count)
+{
+    if (!buf || count < 0)
+        return -1;
+
+    aloha_writer *writer = aloha_writer_for(fd);
+    if (!writer)
+        return aloha_sys_write(fd, buf, count);
+
+    size_t len = (size_t)count;
+    if (writer->used + len > ALOHA_WRITE_BUFFER_SIZE)
+    {
+        aloha_sys_flush(fd);
+        // too large to be worth copying
+        if (len >= ALOHA_WRITE_BUFFER_SIZE)
+            return aloha_write_all(fd, buf, len) ? count : -1;
+    }
+
+    memcpy(writer->data + writer->used, buf, len);
+    writer->used += len;
+    if (writer->line_buffered && memchr(buf, '\n', len))
+        aloha_sys_flush(fd);
+    return count;
+}
+
+// formats straight into the buffer when the descriptor has one
+void aloha_sys_write_int(aloha_int fd, aloha_int value)
+{
+    aloha_writer *writer = aloha_writer_for(fd);
+    if (!writer)
+    {
+        char buf[ALOHA_INT_FORMAT_SIZE];
+        aloha_sys_write(fd, buf, (aloha_int)aloha_format_int(buf, value));
+        return;
+    }
+
+    if (writer->used + ALOHA_INT_FORMAT_SIZE > ALOHA_WRITE_BUFFER_SIZE)
+        aloha_sys_flush(fd);
+    writer->used += aloha_format_int(writer->data + writer->used, value);
+}
+
+void aloha_sys_write_float(aloha_int fd, aloha_float value)
+{
+    aloha_writer *writer = aloha_writer_for(fd);
+    if (!writer)
+    {
+        char buf[ALOHA_FLOAT_FORMAT_SIZE];
+        aloha_sys_write(fd, buf, (aloha_int)aloha_format_float(buf, value));
+        return;
+    }
+
+    if (writer->used + ALOHA_FLOAT_FORMAT_SIZE > ALOHA_WRITE_BUFFER_SIZE)
+        aloha_sys_flush(fd);
+    writer->used += aloha_format_float(writer->data + writer->used, value);
+}
+
 aloha_int aloha_sys_write(aloha_int fd, const char *buf, aloha_int count)
 {
     if (!buf || count < 0)
         return -1;
+    // keep the order with anything still buffered for the same descriptor
+    aloha_sys_flush(fd);
     ssize_t result = write((int)fd, buf, (size_t)count);
     return (aloha_int)result;
 }
@@ -16,68 +146,52 @@ aloha_int aloha_sys_read(aloha_int fd, char *buf, aloha_int count)
 {
     if (!buf || count < 0)
         return -1;
+    // a prompt written before reading must be visible
+    aloha_flush_all();
     ssize_t result = read((int)fd, buf, (size_t)count);
     return (aloha_int)result;
 }
 
+// the caller owns the result and releases it with aloha_string_free, not
+// free(); aloha_string_from_int allocates in an arena instead
 char *aloha_sys_int_to_string(aloha_int value)
 {
-    char *buf = (char *)malloc(24);
-    if (!buf)
-        return NULL;
-
-    int len = snprintf(buf, 24, "%ld", value);
-    if (len < 0)
-    {
-        free(buf);
-        return NULL;
-    }
-
-    return buf;
+    return aloha_string_from_int(NULL, value);
 }
 
 char *aloha_sys_float_to_string(aloha_float value)
 {
-    char *buf = (char *)malloc(32);
-    if (!buf)
-        return NULL;
-
-    int len = snprintf(buf, 32, "%g", value);
-    if (len < 0)
-    {
-        free(buf);
-        return NULL;
-    }
-
-    return buf;
+    return aloha_string_from_float(NULL, value);
 }
 
 void aloha_sys_exit(aloha_int code)
 {
+    // buffered output is flushed by the atexit handler
     exit((int)code);
 }
 
 void aloha_sys_abort(void)
 {
+    // abort does not run atexit handlers
+    aloha_flush_all();
     abort();
 }
 
+// reads through a line reader of its own, so input() and a reader made for
+// stdin must not be mixed; the caller owns the result
 char *aloha_sys_input(void)
 {
-    char *line = NULL;
-    size_t len = 0;
-    ssize_t nread = getline(&line, &len, stdin);
+    static void *stdin_reader = NULL;
+    if (!stdin_reader)
+        stdin_reader = aloha_line_reader_new(aloha_arena_new(), 0);
 
-    if (nread == -1)
-    {
-        free(line);
+    if (!aloha_line_reader_next(stdin_reader))
         return NULL;
-    }
-
-    if (nread > 0 && line[nread - 1] == '\n')
-    {
-        line[nread - 1] = '\0';
-    }
 
-    return line;
+    const char *line = aloha_line_reader_line(stdin_reader);
+    aloha_int len = aloha_string_length(line);
+    char *result = aloha_string_alloc(NULL, len);
+    if (result)
+        memcpy(result, line, (size_t)len);
+    return result;
 }
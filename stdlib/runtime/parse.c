@@ -0,0 +1,261 @@
+#include "runtime.h"
+
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Number parsing. A whole string must hold exactly one number, optionally
+// surrounded by ASCII whitespace; whether it did is reported through
+// aloha_parse_ok, like errno, so the value can be returned directly.
+
+static bool aloha_parse_status = false;
+
+bool aloha_parse_ok(void)
+{
+    return aloha_parse_status;
+}
+
+static bool aloha_is_space(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f';
+}
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+#define ALOHA_SWAR_DIGITS 1
+
+// eight ASCII digits read as one little-endian word, see Lemire's
+// "Fast float parsing in practice"
+static bool aloha_is_eight_digits(uint64_t chunk)
+{
+    return ((chunk & 0xF0F0F0F0F0F0F0F0ULL) |
+            (((chunk + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+}
+
+static uint32_t aloha_parse_eight_digits(uint64_t chunk)
+{
+    const uint64_t mask = 0x000000FF000000FFULL;
+    const uint64_t mul1 = 0x000F424000000064ULL; // 100 + (1000000 << 32)
+    const uint64_t mul2 = 0x0000271000000001ULL; // 1 + (10000 << 32)
+    chunk -= 0x3030303030303030ULL;
+    chunk = (chunk * 10) + (chunk >> 8); // pairs of digits
+    chunk = (((chunk & mask) * mul1) + (((chunk >> 16) & mask) * mul2)) >> 32;
+    return (uint32_t)chunk;
+}
+#endif
+
+// accumulates the digits at *p into *value, at most max_digits of them;
+// returns how many were read
+static int aloha_parse_digits(const char **p, const char *end, uint64_t *value, int max_digits)
+{
+    const char *q = *p;
+    int count = 0;
+#ifdef ALOHA_SWAR_DIGITS
+    while (end - q >= 8 && count + 8 <= max_digits)
+    {
+        uint64_t chunk;
+        memcpy(&chunk, q, sizeof(chunk));
+        if (!aloha_is_eight_digits(chunk))
+            break;
+        *value = *value * 100000000ULL + aloha_parse_eight_digits(chunk);
+        q += 8;
+        count += 8;
+    }
+#endif
+    while (q < end && count < max_digits && (unsigned)(*q - '0') <= 9)
+    {
+        *value = *value * 10 + (uint64_t)(*q - '0');
+        q++;
+        count++;
+    }
+    *p = q;
+    return count;
+}
+
+// a token without surrounding whitespace
+static bool aloha_parse_int_token(const char *p, const char *end, aloha_int *out)
+{
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        p++;
+    }
+
+    const char *digits_start = p;
+    while (p < end && *p == '0')
+        p++;
+    bool leading_zeros = p > digits_start;
+
+    // 19 digits always fit in 64 bits unsigned; a 20th cannot fit in an int
+    uint64_t value = 0;
+    int count = aloha_parse_digits(&p, end, &value, 19);
+    if (p != end || (count == 0 && !leading_zeros))
+        return false;
+
+    uint64_t limit = negative ? (uint64_t)INT64_MAX + 1 : (uint64_t)INT64_MAX;
+    if (value > limit)
+        return false;
+    *out = negative ? (aloha_int)(0 - value) : (aloha_int)value;
+    return true;
+}
+
+static const double aloha_exact_pow10[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+static bool aloha_parse_float_token(const char *p, const char *end, aloha_float *out)
+{
+    const char *start = p;
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+'))
+    {
+        negative = *p == '-';
+        p++;
+    }
+
+    // the value is mantissa * 10^exponent, keeping up to 19 significant digits
+    uint64_t mantissa = 0;
+    int significant = 0;
+    int64_t exponent = 0;
+    bool any_digit = false;
+    bool truncated = false;
+
+    while (p < end && *p == '0')
+    {
+        any_digit = true;
+        p++;
+    }
+    significant = aloha_parse_digits(&p, end, &mantissa, 19);
+    any_digit |= significant > 0;
+    for (; p < end && (unsigned)(*p - '0') <= 9; p++)
+    {
+        truncated |= *p != '0';
+        exponent++;
+    }
+
+    if (p < end && *p == '.')
+    {
+        p++;
+        if (mantissa == 0)
+        {
+            for (; p < end && *p == '0'; p++)
+            {
+                any_digit = true;
+                exponent--;
+            }
+        }
+        const char *fraction = p;
+        int fraction_digits = aloha_parse_digits(&p, end, &mantissa, 19 - significant);
+        significant += fraction_digits;
+        exponent -= fraction_digits;
+        any_digit |= p > fraction;
+        for (; p < end && (unsigned)(*p - '0') <= 9; p++)
+        {
+            any_digit = true;
+            truncated |= *p != '0';
+        }
+    }
+    if (!any_digit)
+        return false;
+
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        p++;
+        bool negative_exponent = false;
+        if (p < end && (*p == '-' || *p == '+'))
+        {
+            negative_exponent = *p == '-';
+            p++;
+        }
+        if (p == end || (unsigned)(*p - '0') > 9)
+            return false;
+        int64_t written = 0;
+        for (; p < end && (unsigned)(*p - '0') <= 9; p++)
+        {
+            // far beyond any double; only has to stay large
+            if (written < 100000)
+                written = written * 10 + (*p - '0');
+        }
+        exponent += negative_exponent ? -written : written;
+    }
+    if (p != end)
+        return false;
+
+    // Clinger's fast path: both the mantissa and the power of ten are exact
+    // doubles, so one correctly rounded operation gives the exact result
+    if (!truncated && mantissa <= (1ULL << 53) && exponent >= -22 && exponent <= 22)
+    {
+        double value = (double)mantissa;
+        if (exponent < 0)
+            value /= aloha_exact_pow10[-exponent];
+        else
+            value *= aloha_exact_pow10[exponent];
+        *out = negative ? -value : value;
+        return true;
+    }
+
+    // the syntax was checked above, so strtod stops exactly at the end of
+    // the token: at the string's terminator or at the whitespace after it
+    char *parsed_end = NULL;
+    double value = strtod(start, &parsed_end);
+    // finite digits that round to infinity are out of range, like an int
+    // that does not fit
+    if (parsed_end != end || isinf(value))
+        return false;
+    *out = value;
+    return true;
+}
+
+// the string without surrounding whitespace
+static bool aloha_trimmed(const char *str, const char **begin, const char **end)
+{
+    if (!str)
+        return false;
+
+    const char *p = str;
+    const char *q = str + aloha_string_length(str);
+    while (p < q && aloha_is_space(*p))
+        p++;
+    while (q > p && aloha_is_space(q[-1]))
+        q--;
+    *begin = p;
+    *end = q;
+    return true;
+}
+
+aloha_int aloha_parse_int(const char *str)
+{
+    const char *begin, *end;
+    aloha_int value = 0;
+    aloha_parse_status = aloha_trimmed(str, &begin, &end) && aloha_parse_int_token(begin, end, &value);
+    return aloha_parse_status ? value : 0;
+}
+
+aloha_float aloha_parse_float(const char *str)
+{
+    const char *begin, *end;
+    aloha_float value = 0.0;
+    aloha_parse_status = aloha_trimmed(str, &begin, &end) && aloha_parse_float_token(begin, end, &value);
+    return aloha_parse_status ? value : 0.0;
+}
+
+bool aloha_parse_ints(void *vec_ptr, const char *str)
+{
+    const char *p, *end;
+    aloha_parse_status = vec_ptr && aloha_trimmed(str, &p, &end);
+    while (aloha_parse_status && p < end)
+    {
+        const char *token = p;
+        while (p < end && !aloha_is_space(*p))
+            p++;
+
+        aloha_int value;
+        aloha_parse_status = aloha_parse_int_token(token, p, &value);
+        if (aloha_parse_status)
+            aloha_vec_int_push(vec_ptr, value);
+
+        while (p < end && aloha_is_space(*p))
+            p++;
+    }
+    return aloha_parse_status;
+}
@@ -0,0 +1,209 @@
+#include "runtime.h"
+
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define ALOHA_READ_CHUNK_SIZE 65536
+
+// Bulk input. A line reader pulls large chunks from a descriptor into one
+// arena buffer and hands out every line in place: the newline becomes the
+// terminator and the length is written over the bytes just before the line,
+// which belong to the line handed out previously. A line therefore stays
+// valid until the next call to aloha_line_reader_next; clone it to keep it.
+typedef struct aloha_line_reader
+{
+    aloha_arena *arena;
+    aloha_int fd;
+    bool eof;
+    char *buffer;
+    size_t capacity;
+    size_t start; // first byte not handed out yet
+    size_t end;   // end of the bytes read so far
+    char *line;
+} aloha_line_reader;
+
+// room for the length of the first line in the buffer
+#define ALOHA_READER_SLACK sizeof(aloha_string_header)
+
+static ssize_t aloha_read_some(aloha_int fd, char *buf, size_t count)
+{
+    for (;;)
+    {
+        ssize_t result = aloha_sys_read(fd, buf, (aloha_int)count);
+        if (result >= 0 || errno != EINTR)
+            return result;
+    }
+}
+
+void *aloha_line_reader_new(void *arena_ptr, aloha_int fd)
+{
+    if (!arena_ptr)
+        return NULL;
+
+    aloha_line_reader *reader = aloha_arena_alloc(arena_ptr, sizeof(aloha_line_reader));
+    char *buffer = aloha_arena_alloc(arena_ptr, ALOHA_READ_CHUNK_SIZE);
+    if (!reader || !buffer)
+        return NULL;
+
+    reader->arena = arena_ptr;
+    reader->fd = fd;
+    reader->eof = false;
+    reader->buffer = buffer;
+    reader->capacity = ALOHA_READ_CHUNK_SIZE;
+    reader->start = ALOHA_READER_SLACK;
+    reader->end = ALOHA_READER_SLACK;
+    reader->line = NULL;
+    return reader;
+}
+
+// turns [start, stop) into the current line and continues at next
+static bool aloha_line_reader_emit(aloha_line_reader *reader, size_t stop, size_t next)
+{
+    char *line = reader->buffer + reader->start;
+    size_t len = stop - reader->start;
+    if (len > 0 && line[len - 1] == '\r')
+        len--;
+
+    line[len] = '\0';
+    aloha_string_set_length(line, (aloha_int)len);
+    reader->line = line;
+    reader->start = next;
+    return true;
+}
+
+// makes room after the unread bytes, moving them to the front or into a
+// buffer twice as large when a single line fills the current one
+static bool aloha_line_reader_make_room(aloha_line_reader *reader)
+{
+    size_t pending = reader->end - reader->start;
+    // one byte stays free for the terminator of a last line without newline
+    if (reader->end + 1 < reader->capacity)
+        return true;
+
+    char *buffer = reader->buffer;
+    size_t capacity = reader->capacity;
+    if (ALOHA_READER_SLACK + pending + 1 >= capacity)
+    {
+        capacity *= 2;
+        buffer = aloha_arena_alloc(reader->arena, (aloha_int)capacity);
+        if (!buffer)
+            return false;
+    }
+
+    memmove(buffer + ALOHA_READER_SLACK, reader->buffer + reader->start, pending);
+    reader->buffer = buffer;
+    reader->capacity = capacity;
+    reader->start = ALOHA_READER_SLACK;
+    reader->end = ALOHA_READER_SLACK + pending;
+    return true;
+}
+
+bool aloha_line_reader_next(void *reader_ptr)
+{
+    if (!reader_ptr)
+        return false;
+
+    aloha_line_reader *reader = (aloha_line_reader *)reader_ptr;
+    reader->line = NULL;
+    size_t scanned = reader->start;
+    for (;;)
+    {
+        char *newline = memchr(reader->buffer + scanned, '\n', reader->end - scanned);
+        if (newline)
+        {
+            size_t stop = (size_t)(newline - reader->buffer);
+            return aloha_line_reader_emit(reader, stop, stop + 1);
+        }
+        if (reader->eof)
+        {
+            if (reader->start == reader->end)
+                return false;
+            return aloha_line_reader_emit(reader, reader->end, reader->end);
+        }
+
+        // only the new bytes need to be searched next time
+        size_t searched = reader->end - reader->start;
+        if (!aloha_line_reader_make_room(reader))
+            return false;
+        scanned = reader->start + searched;
+
+        ssize_t count = aloha_read_some(reader->fd, reader->buffer + reader->end,
+                                        reader->capacity - reader->end - 1);
+        if (count <= 0)
+            reader->eof = true;
+        else
+            reader->end += (size_t)count;
+    }
+}
+
+char *aloha_line_reader_line(void *reader_ptr)
+{
+    if (!reader_ptr)
+        return NULL;
+    return ((aloha_line_reader *)reader_ptr)->line;
+}
+
+char *aloha_read_all(void *arena_ptr, aloha_int fd)
+{
+    if (!arena_ptr)
+        return NULL;
+
+    // what is left of a regular file is read straight into the result
+    struct stat st;
+    off_t offset;
+    if (fstat((int)fd, &st) == 0 && S_ISREG(st.st_mode) &&
+        (offset = lseek((int)fd, 0, SEEK_CUR)) >= 0)
+    {
+        aloha_int expected = st.st_size > offset ? (aloha_int)(st.st_size - offset) : 0;
+        char *result = aloha_string_alloc(arena_ptr, expected);
+        if (!result)
+            return NULL;
+
+        aloha_int len = 0;
+        while (len < expected)
+        {
+            ssize_t count = aloha_read_some(fd, result + len, (size_t)(expected - len));
+            if (count <= 0)
+                break;
+            len += count;
+        }
+        // the file shrank while it was read
+        result[len] = '\0';
+        aloha_string_set_length(result, len);
+        return result;
+    }
+
+    // pipes and terminals are collected first, then copied once
+    size_t capacity = ALOHA_READ_CHUNK_SIZE;
+    size_t len = 0;
+    char *data = malloc(capacity);
+    if (!data)
+        return NULL;
+    for (;;)
+    {
+        if (len == capacity)
+        {
+            char *grown = realloc(data, capacity * 2);
+            if (!grown)
+            {
+                free(data);
+                return NULL;
+            }
+            data = grown;
+            capacity *= 2;
+        }
+        ssize_t count = aloha_read_some(fd, data + len, capacity - len);
+        if (count <= 0)
+            break;
+        len += (size_t)count;
+    }
+
+    char *result = aloha_string_alloc(arena_ptr, (aloha_int)len);
+    if (result)
+        memcpy(result, data, len);
+    free(data);
+    return result;
+}
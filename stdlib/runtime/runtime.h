@@ -4,6 +4,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <string.h>
 
 typedef int64_t aloha_int;
 typedef double aloha_float;
@@ -12,20 +13,75 @@ typedef struct aloha_arena_block
 {
     struct aloha_arena_block *next;
     size_t capacity;
-    size_t used;
     uint8_t data[];
 } aloha_arena_block;
 
+// Small allocations bump cursor through the current block; blocks double in
+// size up to a limit. Allocations too large for that get a block of their
+// own on a separate chain, leaving the current block in use. codegen reads
+// cursor and limit directly for the inline path of new(arena) (see
+// src/codegen/intrinsics.cc); keep the field order.
 typedef struct aloha_arena
 {
+    uint8_t *cursor;
+    uint8_t *limit;
     aloha_arena_block *blocks;
+    aloha_arena_block *large_blocks;
+    size_t next_capacity;
 } aloha_arena;
 
+// A string is a pointer to NUL-terminated bytes that are preceded by their
+// length, so C code can take it as a plain char * while the length is read
+// without scanning. Literals are laid out the same way by codegen. Strings
+// built in place inside a buffer may leave the length unaligned.
+typedef struct aloha_string_header
+{
+    aloha_int len;
+    char data[];
+} aloha_string_header;
+
+static inline aloha_int aloha_string_length(const char *str)
+{
+    aloha_int len;
+    memcpy(&len, str - offsetof(aloha_string_header, data), sizeof(len));
+    return len;
+}
+
+static inline void aloha_string_set_length(char *str, aloha_int len)
+{
+    memcpy(str - offsetof(aloha_string_header, data), &len, sizeof(len));
+}
+
 void *aloha_arena_new(void);
 void *aloha_arena_alloc(void *arena_ptr, aloha_int size);
+void *aloha_arena_alloc_slow(aloha_arena *arena, size_t size);
 void aloha_arena_free_all(void *arena_ptr);
 
+// the bump-pointer path of aloha_arena_alloc, for runtime code that already
+// holds a valid arena; size must be positive
+static inline void *aloha_arena_bump(aloha_arena *arena, size_t size)
+{
+    size = (size + 7) & ~(size_t)7;
+    if ((size_t)(arena->limit - arena->cursor) < size)
+        return aloha_arena_alloc_slow(arena, size);
+
+    void *ptr = arena->cursor;
+    arena->cursor += size;
+    return ptr;
+}
+
+// enough room for any formatted int or float
+#define ALOHA_INT_FORMAT_SIZE 24
+#define ALOHA_FLOAT_FORMAT_SIZE 32
+
+size_t aloha_format_int(char *out, aloha_int value);
+size_t aloha_format_float(char *out, aloha_float value);
+
 aloha_int aloha_sys_write(aloha_int fd, const char *buf, aloha_int count);
+aloha_int aloha_sys_buffered_write(aloha_int fd, const char *buf, aloha_int count);
+void aloha_sys_flush(aloha_int fd);
+void aloha_sys_write_int(aloha_int fd, aloha_int value);
+void aloha_sys_write_float(aloha_int fd, aloha_float value);
 aloha_int aloha_sys_read(aloha_int fd, char *buf, aloha_int count);
 aloha_int aloha_sys_strlen(const char *str);
 bool aloha_sys_str_eq(const char *left, const char *right);
@@ -35,11 +91,59 @@ void aloha_sys_exit(aloha_int code);
 void aloha_sys_abort(void);
 char *aloha_sys_input(void);
 
+char *aloha_string_alloc(void *arena_ptr, aloha_int len);
+void aloha_string_free(char *str);
+char *aloha_string_from_cstr(const char *str);
+void aloha_foreign_strings_free(void);
 char *aloha_string_clone(void *arena_ptr, const char *str);
+char *aloha_string_from_int(void *arena_ptr, aloha_int value);
+char *aloha_string_from_float(void *arena_ptr, aloha_float value);
 char *aloha_string_concat(void *arena_ptr, const char *left, const char *right);
 aloha_int aloha_string_char_at(const char *str, aloha_int index);
 char *aloha_string_slice(void *arena_ptr, const char *str, aloha_int start, aloha_int len);
 
+const char *aloha_find_bytes(const char *haystack, size_t len, const char *needle, size_t needle_len);
+aloha_int aloha_compare_bytes(const char *left, size_t left_len, const char *right, size_t right_len);
+aloha_int aloha_string_find(const char *str, const char *needle);
+aloha_int aloha_string_find_byte(const char *str, aloha_int code);
+bool aloha_string_starts_with(const char *str, const char *prefix);
+aloha_int aloha_string_compare(const char *left, const char *right);
+void *aloha_string_split(void *arena_ptr, const char *str, const char *separator);
+
+void aloha_slice_check(aloha_int start, aloha_int len, aloha_int limit);
+bool aloha_slice_equals(const char *left, aloha_int left_start, aloha_int left_len,
+                        const char *right, aloha_int right_start, aloha_int right_len);
+aloha_int aloha_slice_compare(const char *left, aloha_int left_start, aloha_int left_len,
+                              const char *right, aloha_int right_start, aloha_int right_len);
+aloha_int aloha_slice_hash(const char *source, aloha_int start, aloha_int len);
+aloha_int aloha_slice_find(const char *source, aloha_int start, aloha_int len, const char *needle);
+void aloha_slice_write(aloha_int fd, const char *source, aloha_int start, aloha_int len);
+
+void *aloha_string_builder_new(void *arena_ptr);
+void aloha_string_builder_append(void *builder_ptr, const char *str);
+void aloha_string_builder_append_int(void *builder_ptr, aloha_int value);
+void aloha_string_builder_append_float(void *builder_ptr, aloha_float value);
+void aloha_string_builder_append_char(void *builder_ptr, aloha_int code);
+aloha_int aloha_string_builder_len(void *builder_ptr);
+char *aloha_string_builder_finish(void *builder_ptr);
+
+aloha_int aloha_file_open(const char *path);
+void aloha_file_close(aloha_int fd);
+void *aloha_file_map(aloha_int fd);
+bool aloha_mapped_file_ok(void *file_ptr);
+char *aloha_mapped_file_contents(void *file_ptr);
+void aloha_file_unmap(void *file_ptr);
+
+void *aloha_line_reader_new(void *arena_ptr, aloha_int fd);
+bool aloha_line_reader_next(void *reader_ptr);
+char *aloha_line_reader_line(void *reader_ptr);
+char *aloha_read_all(void *arena_ptr, aloha_int fd);
+
+aloha_int aloha_parse_int(const char *str);
+aloha_float aloha_parse_float(const char *str);
+bool aloha_parse_ok(void);
+bool aloha_parse_ints(void *vec_ptr, const char *str);
+
 void *aloha_vec_int_new(void *arena_ptr);
 void aloha_vec_int_push(void *vec_ptr, aloha_int value);
 aloha_int aloha_vec_int_len(void *vec_ptr);
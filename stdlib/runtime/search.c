@@ -0,0 +1,192 @@
+#include "runtime.h"
+
+#include <string.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ALOHA_X86_SEARCH 1
+#endif
+
+// Substring search and the string operations built on it. A needle is
+// looked for by comparing its first and last byte against a whole vector of
+// positions at once, see Muła's "SIMD-friendly algorithms for substring
+// searching"; only positions where both match are checked in full. SSE2 is
+// always available on x86-64, AVX2 is used when the CPU has it.
+
+typedef const char *(*aloha_find_kernel)(const char *haystack, size_t len, const char *needle, size_t needle_len);
+
+// every kernel takes needle_len >= 2 and needle_len <= len
+static const char *aloha_find_scalar(const char *haystack, size_t len, const char *needle, size_t needle_len)
+{
+    const char *p = haystack;
+    const char *last = haystack + (len - needle_len);
+    while (p <= last)
+    {
+        p = memchr(p, needle[0], (size_t)(last - p) + 1);
+        if (!p)
+            return NULL;
+        if (memcmp(p + 1, needle + 1, needle_len - 1) == 0)
+            return p;
+        p++;
+    }
+    return NULL;
+}
+
+#ifdef ALOHA_X86_SEARCH
+// candidates are the set bits of mask, for the positions starting at p
+static const char *aloha_find_candidates(const char *p, unsigned mask, const char *needle, size_t needle_len)
+{
+    while (mask)
+    {
+        const char *candidate = p + __builtin_ctz(mask);
+        // the first and last byte already match
+        if (memcmp(candidate + 1, needle + 1, needle_len - 2) == 0)
+            return candidate;
+        mask &= mask - 1;
+    }
+    return NULL;
+}
+
+static const char *aloha_find_sse2(const char *haystack, size_t len, const char *needle, size_t needle_len)
+{
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[needle_len - 1]);
+
+    size_t i = 0;
+    // the last bytes of 16 positions must still lie inside the haystack
+    for (; i + needle_len - 1 + 16 <= len; i += 16)
+    {
+        __m128i block_first = _mm_loadu_si128((const __m128i *)(haystack + i));
+        __m128i block_last = _mm_loadu_si128((const __m128i *)(haystack + i + needle_len - 1));
+        __m128i both = _mm_and_si128(_mm_cmpeq_epi8(first, block_first), _mm_cmpeq_epi8(last, block_last));
+        const char *found = aloha_find_candidates(haystack + i, (unsigned)_mm_movemask_epi8(both),
+                                                  needle, needle_len);
+        if (found)
+            return found;
+    }
+    return aloha_find_scalar(haystack + i, len - i, needle, needle_len);
+}
+
+__attribute__((target("avx2"))) static const char *aloha_find_avx2(const char *haystack, size_t len,
+                                                                   const char *needle, size_t needle_len)
+{
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[needle_len - 1]);
+
+    size_t i = 0;
+    for (; i + needle_len - 1 + 32 <= len; i += 32)
+    {
+        __m256i block_first = _mm256_loadu_si256((const __m256i *)(haystack + i));
+        __m256i block_last = _mm256_loadu_si256((const __m256i *)(haystack + i + needle_len - 1));
+        __m256i both = _mm256_and_si256(_mm256_cmpeq_epi8(first, block_first), _mm256_cmpeq_epi8(last, block_last));
+        const char *found = aloha_find_candidates(haystack + i, (unsigned)_mm256_movemask_epi8(both),
+                                                  needle, needle_len);
+        if (found)
+            return found;
+    }
+    return aloha_find_sse2(haystack + i, len - i, needle, needle_len);
+}
+#endif
+
+static aloha_find_kernel aloha_select_find_kernel(void)
+{
+#ifdef ALOHA_X86_SEARCH
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2"))
+        return aloha_find_avx2;
+    return aloha_find_sse2;
+#else
+    return aloha_find_scalar;
+#endif
+}
+
+const char *aloha_find_bytes(const char *haystack, size_t len, const char *needle, size_t needle_len)
+{
+    static aloha_find_kernel kernel = NULL;
+
+    if (needle_len == 0)
+        return haystack;
+    if (needle_len > len)
+        return NULL;
+    // libc's memchr is already vectorized
+    if (needle_len == 1)
+        return memchr(haystack, needle[0], len);
+
+    if (!kernel)
+        kernel = aloha_select_find_kernel();
+    return kernel(haystack, len, needle, needle_len);
+}
+
+aloha_int aloha_string_find(const char *str, const char *needle)
+{
+    if (!str || !needle)
+        return -1;
+
+    const char *found = aloha_find_bytes(str, (size_t)aloha_string_length(str), needle,
+                                         (size_t)aloha_string_length(needle));
+    return found ? (aloha_int)(found - str) : -1;
+}
+
+aloha_int aloha_string_find_byte(const char *str, aloha_int code)
+{
+    if (!str)
+        return -1;
+
+    const char *found = memchr(str, (int)(unsigned char)code, (size_t)aloha_string_length(str));
+    return found ? (aloha_int)(found - str) : -1;
+}
+
+bool aloha_string_starts_with(const char *str, const char *prefix)
+{
+    if (!str || !prefix)
+        return false;
+
+    aloha_int prefix_len = aloha_string_length(prefix);
+    return prefix_len <= aloha_string_length(str) && memcmp(str, prefix, (size_t)prefix_len) == 0;
+}
+
+// byte-wise order, a prefix coming before the longer string; -1, 0 or 1
+aloha_int aloha_compare_bytes(const char *left, size_t left_len, const char *right, size_t right_len)
+{
+    int cmp = memcmp(left, right, left_len < right_len ? left_len : right_len);
+    if (cmp == 0)
+        return (left_len > right_len) - (left_len < right_len);
+    return cmp < 0 ? -1 : 1;
+}
+
+aloha_int aloha_string_compare(const char *left, const char *right)
+{
+    if (!left || !right)
+        return (left != NULL) - (right != NULL);
+
+    return aloha_compare_bytes(left, (size_t)aloha_string_length(left),
+                               right, (size_t)aloha_string_length(right));
+}
+
+// the pieces between separators, copied into arena; an empty separator
+// gives the whole string as the only piece
+void *aloha_string_split(void *arena_ptr, const char *str, const char *separator)
+{
+    void *pieces = aloha_vec_string_new(arena_ptr);
+    if (!pieces || !str || !separator)
+        return pieces;
+
+    const char *p = str;
+    const char *end = str + aloha_string_length(str);
+    size_t separator_len = (size_t)aloha_string_length(separator);
+    for (;;)
+    {
+        const char *found = separator_len ? aloha_find_bytes(p, (size_t)(end - p), separator, separator_len) : NULL;
+        const char *piece_end = found ? found : end;
+
+        char *piece = aloha_string_alloc(arena_ptr, (aloha_int)(piece_end - p));
+        if (!piece)
+            return pieces;
+        memcpy(piece, p, (size_t)(piece_end - p));
+        aloha_vec_string_push(pieces, piece);
+
+        if (!found)
+            return pieces;
+        p = found + separator_len;
+    }
+}
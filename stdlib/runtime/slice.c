@@ -0,0 +1,55 @@
+#include "runtime.h"
+
+#include <string.h>
+
+// Borrowed slices. stdlib/slice.alo keeps a slice as its source string and
+// a range, so taking one copies nothing; these helpers work on the range in
+// place. Ranges are checked once, when the slice is made.
+
+#define ALOHA_FNV_OFFSET 0xcbf29ce484222325ULL
+#define ALOHA_FNV_PRIME 0x100000001b3ULL
+
+// aborts unless [start, start + len) lies within [0, limit)
+void aloha_slice_check(aloha_int start, aloha_int len, aloha_int limit)
+{
+    if (start < 0 || len < 0 || start > limit || len > limit - start)
+        aloha_sys_abort();
+}
+
+bool aloha_slice_equals(const char *left, aloha_int left_start, aloha_int left_len,
+                        const char *right, aloha_int right_start, aloha_int right_len)
+{
+    return left_len == right_len &&
+           memcmp(left + left_start, right + right_start, (size_t)left_len) == 0;
+}
+
+aloha_int aloha_slice_compare(const char *left, aloha_int left_start, aloha_int left_len,
+                              const char *right, aloha_int right_start, aloha_int right_len)
+{
+    return aloha_compare_bytes(left + left_start, (size_t)left_len, right + right_start, (size_t)right_len);
+}
+
+// 64-bit FNV-1a, so equal bytes hash alike whatever string holds them
+aloha_int aloha_slice_hash(const char *source, aloha_int start, aloha_int len)
+{
+    const unsigned char *p = (const unsigned char *)source + start;
+    uint64_t hash = ALOHA_FNV_OFFSET;
+    for (aloha_int i = 0; i < len; i++)
+        hash = (hash ^ p[i]) * ALOHA_FNV_PRIME;
+    return (aloha_int)hash;
+}
+
+// index of needle relative to the start of the slice, or -1
+aloha_int aloha_slice_find(const char *source, aloha_int start, aloha_int len, const char *needle)
+{
+    if (!needle)
+        return -1;
+
+    const char *found = aloha_find_bytes(source + start, (size_t)len, needle, (size_t)aloha_string_length(needle));
+    return found ? (aloha_int)(found - (source + start)) : -1;
+}
+
+void aloha_slice_write(aloha_int fd, const char *source, aloha_int start, aloha_int len)
+{
+    aloha_sys_buffered_write(fd, source + start, len);
+}
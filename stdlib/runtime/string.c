@@ -1,12 +1,67 @@
 #include "runtime.h"
 
+#include <stdlib.h>
 #include <string.h>
 
+char *aloha_string_alloc(void *arena_ptr, aloha_int len)
+{
+    if (len < 0)
+        return NULL;
+
+    // without an arena the string is owned by the caller, like the
+    // results of aloha_sys_input and the number formatters, and released
+    // with aloha_string_free
+    aloha_int size = (aloha_int)sizeof(aloha_string_header) + len + 1;
+    aloha_string_header *header = arena_ptr ? aloha_arena_alloc(arena_ptr, size) : malloc((size_t)size);
+    if (!header)
+        return NULL;
+
+    header->len = len;
+    header->data[len] = '\0';
+    return header->data;
+}
+
+// str points past its length header, so it cannot be handed to free() itself
+void aloha_string_free(char *str)
+{
+    if (str)
+        free(str - offsetof(aloha_string_header, data));
+}
+
+// Strings returned by extern C functions have no length header, so codegen
+// copies each one here. The copies belong to the runtime and stay valid
+// until aloha_foreign_strings_free releases all of them at once.
+static void *aloha_foreign_strings = NULL;
+
+char *aloha_string_from_cstr(const char *str)
+{
+    if (!str)
+        return NULL;
+    if (!aloha_foreign_strings)
+        aloha_foreign_strings = aloha_arena_new();
+    if (!aloha_foreign_strings)
+        return NULL;
+
+    size_t len = strlen(str);
+    char *result = aloha_string_alloc(aloha_foreign_strings, (aloha_int)len);
+    if (!result)
+        return NULL;
+
+    memcpy(result, str, len);
+    return result;
+}
+
+void aloha_foreign_strings_free(void)
+{
+    aloha_arena_free_all(aloha_foreign_strings);
+    aloha_foreign_strings = NULL;
+}
+
 aloha_int aloha_sys_strlen(const char *str)
 {
     if (!str)
         return 0;
-    return (aloha_int)strlen(str);
+    return aloha_string_length(str);
 }
 
 bool aloha_sys_str_eq(const char *left, const char *right)
@@ -14,7 +69,10 @@ bool aloha_sys_str_eq(const char *left, const char *right)
     if (!left || !right)
         return left == right;
 
-    return strcmp(left, right) == 0;
+    aloha_int len = aloha_string_length(left);
+    if (len != aloha_string_length(right))
+        return false;
+    return memcmp(left, right, (size_t)len) == 0;
 }
 
 char *aloha_string_clone(void *arena_ptr, const char *str)
@@ -22,12 +80,12 @@ char *aloha_string_clone(void *arena_ptr, const char *str)
     if (!arena_ptr || !str)
         return NULL;
 
-    size_t len = strlen(str);
-    char *copy = aloha_arena_alloc(arena_ptr, (aloha_int)(len + 1));
+    aloha_int len = aloha_string_length(str);
+    char *copy = aloha_string_alloc(arena_ptr, len);
     if (!copy)
         return NULL;
 
-    memcpy(copy, str, len + 1);
+    memcpy(copy, str, (size_t)len);
     return copy;
 }
 
@@ -36,21 +94,16 @@ char *aloha_string_concat(void *arena_ptr, const char *left, const char *right)
     if (!arena_ptr)
         return NULL;
 
-    if (!left)
-        left = "";
-    if (!right)
-        right = "";
-
-    size_t left_len = strlen(left);
-    size_t right_len = strlen(right);
-    size_t total_len = left_len + right_len;
-    char *result = aloha_arena_alloc(arena_ptr, (aloha_int)(total_len + 1));
+    aloha_int left_len = left ? aloha_string_length(left) : 0;
+    aloha_int right_len = right ? aloha_string_length(right) : 0;
+    char *result = aloha_string_alloc(arena_ptr, left_len + right_len);
     if (!result)
         return NULL;
 
-    memcpy(result, left, left_len);
-    memcpy(result + left_len, right, right_len);
-    result[total_len] = '\0';
+    if (left_len > 0)
+        memcpy(result, left, (size_t)left_len);
+    if (right_len > 0)
+        memcpy(result + left_len, right, (size_t)right_len);
     return result;
 }
 
@@ -59,8 +112,7 @@ aloha_int aloha_string_char_at(const char *str, aloha_int index)
     if (!str || index < 0)
         aloha_sys_abort();
 
-    size_t str_len = strlen(str);
-    if ((size_t)index >= str_len)
+    if (index >= aloha_string_length(str))
         aloha_sys_abort();
 
     return (aloha_int)(unsigned char)str[index];
@@ -71,17 +123,14 @@ char *aloha_string_slice(void *arena_ptr, const char *str, aloha_int start, aloh
     if (!arena_ptr || !str || start < 0 || len < 0)
         aloha_sys_abort();
 
-    size_t str_len = strlen(str);
-    size_t slice_start = (size_t)start;
-    size_t slice_len = (size_t)len;
-    if (slice_start > str_len || slice_len > str_len - slice_start)
+    aloha_int str_len = aloha_string_length(str);
+    if (start > str_len || len > str_len - start)
         aloha_sys_abort();
 
-    char *result = aloha_arena_alloc(arena_ptr, (aloha_int)(slice_len + 1));
+    char *result = aloha_string_alloc(arena_ptr, len);
     if (!result)
         return NULL;
 
-    memcpy(result, str + slice_start, slice_len);
-    result[slice_len] = '\0';
+    memcpy(result, str + start, (size_t)len);
     return result;
 }
@@ -2,6 +2,8 @@
 
 #include <string.h>
 
+// codegen reads data, len and cap directly for the inline fast paths of
+// get/set/push/len (see src/codegen/intrinsics.cc); keep the field order
 typedef struct
 {
     uint8_t *data;
@@ -0,0 +1,17 @@
+# --release removes asserts when the stdlib is compiled from its sources
+# instead of read from the precompiled interfaces; copying the sources makes
+# those interfaces older than them
+set -e
+
+mkdir -p root
+cp -R "$PROJECT_DIR/stdlib" root/
+
+cat > main.alo <<'ALO'
+fun main() -> int {
+  assert(1 + 1 == 3);
+  return 0;
+}
+ALO
+
+output=$(ALOHA_DEV="$PWD/root" "$COMPILER" main.alo --release --remarks --no-link 2>&1)
+echo "$output" | grep -q "remark: assert removed"
@@ -0,0 +1,22 @@
+# Each input() returns a string of its own: an earlier line keeps its
+# contents and length after later lines are read, with and without -O
+set -e
+
+cat > main.alo <<'ALO'
+fun main() -> int {
+    imut a = input();
+    imut b = input();
+    println(a);
+    printlnInt(string_len(a));
+    println(b);
+    return 0;
+}
+ALO
+
+expected=$(printf 'first line here\n15\nsecond')
+
+"$COMPILER" main.alo -o plain > /dev/null
+test "$(printf 'first line here\nsecond\n' | ./plain.out)" = "$expected"
+
+"$COMPILER" main.alo -o optimized -O > /dev/null
+test "$(printf 'first line here\nsecond\n' | ./optimized.out)" = "$expected"
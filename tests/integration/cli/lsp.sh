@@ -0,0 +1,107 @@
+# The language server answers over stdio, resolves local variables through
+# the scopes of the function around the cursor and keeps its answers right
+# while single function bodies are edited
+set -e
+export LC_ALL=C
+
+# a file's contents as the body of a JSON string
+json_text() {
+    awk '{ gsub(/\\/, "\\\\"); gsub(/"/, "\\\""); gsub(/\t/, "\\t"); printf "%s\\n", $0 }' "$1"
+}
+
+message() {
+    printf 'Content-Length: %d\r\n\r\n%s' "${#1}" "$1"
+}
+
+URI="file://$PWD/doc.alo"
+
+open() {
+    message "{\"jsonrpc\":\"2.0\",\"method\":\"textDocument/didOpen\",\"params\":{\"textDocument\":{\"uri\":\"$URI\",\"version\":1,\"text\":\"$(json_text "$1")\"}}}"
+}
+
+change() {
+    message "{\"jsonrpc\":\"2.0\",\"method\":\"textDocument/didChange\",\"params\":{\"textDocument\":{\"uri\":\"$URI\",\"version\":2},\"contentChanges\":[{\"text\":\"$(json_text "$1")\"}]}}"
+}
+
+# request id, method, zero based line and character
+at() {
+    message "{\"jsonrpc\":\"2.0\",\"id\":$1,\"method\":\"textDocument/$2\",\"params\":{\"textDocument\":{\"uri\":\"$URI\"},\"position\":{\"line\":$3,\"character\":$4}}}"
+}
+
+cat > v1.alo <<'ALO'
+fun helper(x: int) -> int {
+    imut y = x + 1;
+    return y;
+}
+
+fun main() -> int {
+    mut y = 2;
+    if (y > 1) {
+        imut y = 5;
+        printlnInt(y);
+    }
+    y = y + 1;
+    return helper(y);
+}
+ALO
+
+# helper's body gains a line with a type error, which moves main down
+sed 's/^    imut y = x + 1;$/&\n    imut z: string = y;/' v1.alo > v2.alo
+# the body does not parse
+sed 's/imut z: string = y;/imut z: int = ;/' v2.alo > v3.alo
+sed 's/imut z: string = y;/imut z: int = y;/' v2.alo > v4.alo
+# a signature change
+sed 's/fun helper(x: int)/fun helper(x: int, w: int)/' v4.alo > v5.alo
+
+{
+    message '{"jsonrpc":"2.0","id":1,"method":"initialize","params":{}}'
+    # without a valid length the message is skipped
+    printf 'Content-Length: many\r\n\r\n{}'
+    open v1.alo
+    at 10 definition 9 19   # y inside the if block
+    at 11 definition 11 8   # y after the block closed
+    at 12 hover 11 8
+    at 13 definition 2 11   # y in helper
+    change v2.alo
+    at 20 definition 12 8   # main moved down a line
+    change v3.alo
+    at 30 definition 12 8
+    change v4.alo
+    change v5.alo
+    message '{"jsonrpc":"2.0","id":2,"method":"shutdown"}'
+    message '{"jsonrpc":"2.0","method":"exit"}'
+} > requests
+
+"$COMPILER" lsp < requests > responses 2> errors
+
+# one message per line
+tr -d '\r' < responses | sed 's/}Content-Length: [0-9]*$/}/' | grep '^{' > messages
+
+response() {
+    grep "^{\"id\":$1," messages
+}
+
+diagnostics() {
+    grep 'publishDiagnostics' messages | sed -n "$1p"
+}
+
+grep -q 'without a valid Content-Length' errors
+response 1 | grep -q '"hoverProvider":true'
+
+response 10 | grep -q '"start":{"character":8,"line":8}'
+response 11 | grep -q '"start":{"character":4,"line":6}'
+response 12 | grep -qF 'aloha\nmut y'
+response 13 | grep -q '"start":{"character":4,"line":1}'
+diagnostics 1 | grep -q '"diagnostics":\[\]'
+
+diagnostics 2 | grep -q "expected 'string', got 'int'"
+diagnostics 2 | grep -q '"start":{"character":4,"line":2}'
+response 20 | grep -q '"start":{"character":4,"line":7}'
+
+diagnostics 3 | grep -q 'Unexpected token'
+response 30 | grep -q '"start":{"character":4,"line":7}'
+
+diagnostics 4 | grep -q '"diagnostics":\[\]'
+diagnostics 5 | grep -q "Function 'helper' expects 2 argument(s), got 1"
+
+response 2 | grep -q '"result":null'
@@ -0,0 +1,34 @@
+# With -O the bitcode written next to module interfaces is linked in, so
+# calls into precompiled modules, the stdlib included, can be inlined
+set -e
+
+mkdir -p lib
+cat > lib/counter.alo <<'ALO'
+pub fun step(value: int) -> int {
+    return value + 3;
+}
+ALO
+
+(cd lib && "$COMPILER" counter.alo --emit-interface --no-link > /dev/null)
+test -f lib/counter.bc
+
+cat > main.alo <<'ALO'
+import "lib/counter.alo";
+
+fun main() -> int {
+    printlnInt(step(4));
+    return 0;
+}
+ALO
+
+"$COMPILER" main.alo -o main -O --emit-llvm > /dev/null
+test "$(./main.out)" = "7"
+
+# both the module's function and the stdlib wrapper were inlined
+if grep -E "call .*@(step|printlnInt)\(" main.ll; then
+    exit 1
+fi
+
+# without -O the calls stay
+"$COMPILER" main.alo -o plain --emit-llvm > /dev/null
+grep -qE "call .*@step\(" plain.ll
@@ -0,0 +1,152 @@
+# A module compiled with --emit-interface is imported through its .aloi:
+# structs, enums, extern types and attributes survive the round trip, the
+# object path is stored relative to the interface, and a damaged interface
+# is rejected in favour of the source
+set -e
+
+mkdir -p lib
+cat > lib/shapes.alo <<'ALO'
+pub extern type Canvas;
+
+pub struct Size {
+    width: int,
+    height: int,
+}
+
+pub enum Shape {
+    Square,
+    Wide,
+}
+
+pub fun area(size: Size) -> int {
+    return size->width * size->height;
+}
+
+pub fun classify(size: Size) -> Shape {
+    if (size->width > size->height) {
+        return Shape::Wide;
+    }
+    return Shape::Square;
+}
+
+pub fun has_canvas(canvas: &Canvas) -> bool {
+    return true;
+}
+
+@pure
+pub fun double_width(size: Size) -> int {
+    return size->width * 2;
+}
+
+@cold @noinline
+pub fun complain(message: string) -> void {
+    eprintln(message);
+}
+
+pub fun version() -> int {
+    return 1;
+}
+ALO
+
+(cd lib && "$COMPILER" shapes.alo --emit-interface --no-link > /dev/null)
+test -f lib/shapes.aloi
+
+# the object is found relative to the interface, so the pair can move
+if grep -aqF "$PWD/lib/shapes.o" lib/shapes.aloi; then
+    echo "object path stored as an absolute path"
+    exit 1
+fi
+grep -aqF "shapes.o" lib/shapes.aloi
+mv lib moved
+
+# an edited body proves the compiled object is linked, not the source; the
+# source is dated back so the interface still counts as current
+sed -i 's/return 1;/return 2;/' moved/shapes.alo
+touch -d "@$(($(stat -c %Y moved/shapes.aloi) - 60))" moved/shapes.alo
+
+cat > main.alo <<'ALO'
+import "moved/shapes.alo";
+
+fun draw(canvas: &Canvas) -> bool {
+    return has_canvas(canvas);
+}
+
+fun main() -> int {
+    imut size = Size { width: 3, height: 2 };
+    match classify(size) {
+        Shape::Wide => {
+            printlnInt(area(size) + double_width(size));
+        }
+        Shape::Square => {
+            complain("square");
+        }
+    }
+    printlnInt(version());
+    return 0;
+}
+ALO
+
+ir=$("$COMPILER" main.alo -o main --dump-ir 2>&1)
+if echo "$ir" | grep -q "falling back to source"; then
+    echo "$ir" | grep "falling back to source"
+    exit 1
+fi
+test "$(./main.out)" = "$(printf '12\n1')"
+
+# the attributes of imported declarations reach LLVM
+attribute_group() {
+    echo "$ir" | grep -E "^declare .*@$1\(" | grep -oE '#[0-9]+$'
+}
+echo "$ir" | grep -E "^attributes $(attribute_group complain) = " | grep -q "cold"
+echo "$ir" | grep -E "^attributes $(attribute_group double_width) = " | grep -qE "readnone|memory\(none\)"
+
+# a wrong magic number or version is rejected
+cp moved/shapes.aloi good.aloi
+printf 'X' | dd of=moved/shapes.aloi bs=1 count=1 conv=notrunc 2> /dev/null
+"$COMPILER" main.alo --no-link 2>&1 | grep -q "not a module interface, falling back to source"
+
+cp good.aloi moved/shapes.aloi
+printf '\143\000\000\000' | dd of=moved/shapes.aloi bs=1 seek=4 count=4 conv=notrunc 2> /dev/null
+"$COMPILER" main.alo --no-link 2>&1 | grep -q "unsupported version 99, falling back to source"
+
+# the interface also records the imports its object was compiled against;
+# once one of them changes, e.g. the layout of a struct, the interface is
+# rejected and the module compiled from source again
+mkdir -p geometry
+cat > geometry/point.alo <<'ALO'
+pub struct Point {
+    x: int,
+    y: int,
+}
+ALO
+
+cat > geometry/describe.alo <<'ALO'
+import "point.alo";
+
+pub fun describe(point: Point) -> int {
+    return point->x * 10 + point->y;
+}
+ALO
+
+(cd geometry && "$COMPILER" describe.alo --emit-interface --no-link > /dev/null)
+
+cat > points.alo <<'ALO'
+import "geometry/describe.alo";
+
+fun main() -> int {
+    imut point = Point { x: 1, y: 2 };
+    printlnInt(describe(point));
+    return 0;
+}
+ALO
+
+output=$("$COMPILER" points.alo -o points 2>&1)
+if echo "$output" | grep -q "Ignoring interface"; then
+    echo "$output" | grep "Ignoring interface"
+    exit 1
+fi
+test "$(./points.out)" = "12"
+
+sed -i 's/^    x: int,$/    w: int,\n    x: int,/' geometry/point.alo
+"$COMPILER" points.alo -o points 2>&1 | grep -q "describe.aloi': '.*/geometry/point.alo' changed since it was written"
+test "$(./points.out)" = "12"
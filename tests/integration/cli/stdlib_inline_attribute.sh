@@ -0,0 +1,34 @@
+# @inline on stdlib functions survives precompilation: the module's bitcode
+# marks them alwaysinline, and -O inlines them into the program
+set -e
+
+"$COMPILER" "$PROJECT_DIR/stdlib/math.alo" -o math --no-link --dump-ir > math.ir
+group=$(grep -E "^define .*@absInt\(" math.ir | grep -oE '#[0-9]+')
+grep -E "^attributes $group = " math.ir | grep -q "alwaysinline"
+
+cat > main.alo <<'ALO'
+fun spread(values: &VecInt) -> int {
+    mut total = 0;
+    for (mut i = 0; i < vec_int_len(values); i = i + 1) {
+        total = total + clampInt(absInt(vec_int_get(values, i)), 1, 10);
+    }
+    return total;
+}
+
+fun main() -> int {
+    imut arena = arena_new();
+    imut values = vec_int_new(arena);
+    vec_int_push(values, -4);
+    vec_int_push(values, 0);
+    vec_int_push(values, 25);
+    printlnInt(spread(values));
+    arena_free_all(arena);
+    return 0;
+}
+ALO
+
+"$COMPILER" main.alo -o main -O --emit-llvm > /dev/null
+test "$(./main.out)" = "15"
+if grep -E "call .*@(absInt|clampInt)\(" main.ll; then
+    exit 1
+fi
@@ -0,0 +1,71 @@
+# Watch mode rebuilds when the entry file or an import is saved, compiles
+# imports once into its module cache and rebuilds a cached import only after
+# it or one of its own imports changed
+set -e
+
+cat > deep.alo <<'ALO'
+pub fun base() -> int {
+    return 1;
+}
+ALO
+
+cat > util.alo <<'ALO'
+import "deep.alo";
+
+pub fun twice(x: int) -> int {
+    return x * 2 + base();
+}
+ALO
+
+cat > main.alo <<'ALO'
+import "util.alo";
+
+fun main() -> int {
+    printlnInt(twice(21));
+    return 0;
+}
+ALO
+
+timeout 60 "$COMPILER" watch main.alo --verbose > log 2>&1 &
+watcher=$!
+trap 'kill $watcher 2> /dev/null || true' EXIT
+
+# waits until the watcher is idle after its nth build
+idle_after() {
+    for _ in $(seq 200); do
+        if [ "$(grep -c '^Watching' log)" -ge "$1" ]; then
+            return 0
+        fi
+        sleep 0.1
+    done
+    echo "no build $1"
+    cat log
+    exit 1
+}
+
+cached() {
+    grep -c '^\[INFO\] Cached' log || true
+}
+
+idle_after 1
+test "$(./main.out)" = "43"
+test "$(cached)" = "2"
+ls .aloha-watch/util-*.aloi .aloha-watch/deep-*.o > /dev/null
+
+# the imports are read from the cache
+sed -i 's/twice(21)/twice(10)/' main.alo
+idle_after 2
+test "$(./main.out)" = "21"
+test "$(cached)" = "2"
+
+# a changed dependency invalidates the modules built on it
+sed -i 's/return 1;/return 5;/' deep.alo
+idle_after 3
+test "$(./main.out)" = "25"
+test "$(cached)" = "4"
+
+# saving the same contents does not rebuild
+cp util.alo copy.alo
+mv copy.alo util.alo
+sleep 0.5
+test "$(grep -c 'Compilation successful' log)" = "3"